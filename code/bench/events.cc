@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2014-2015, Julien Bernard
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "game/EventManager.h"
+#include "game/IdMap.h"
+#include "game/Random.h"
+
+/*
+ * Dispatch millions of events across hundreds of event types. The lookup of
+ * the handlers of a type is first timed alone, with IdMap, std::map and
+ * std::unordered_map, and then as part of EventManager::triggerEvent().
+ */
+
+static constexpr std::size_t TYPES = 256;
+static constexpr std::size_t HANDLERS_PER_TYPE = 4;
+
+namespace {
+
+  struct BenchEvent : public game::Event {
+    uint64_t value;
+  };
+
+  uint64_t g_sum = 0;
+
+  game::EventStatus onEvent(game::EventType type, game::Event *event) {
+    g_sum += static_cast<BenchEvent *>(event)->value;
+    return game::EventStatus::KEEP;
+  }
+
+  template<typename Func>
+  double measure(std::size_t count, Func func) {
+    auto start = std::chrono::steady_clock::now();
+    func();
+    std::chrono::duration<double, std::nano> duration = std::chrono::steady_clock::now() - start;
+    return duration.count() / count;
+  }
+
+  template<typename Map>
+  double lookup(const std::vector<game::EventType>& sequence, Map& map) {
+    uint64_t sum = 0;
+
+    double time = measure(sequence.size(), [&]() {
+      for (auto type : sequence) {
+        sum += map.find(type)->second;
+      }
+    });
+
+    g_sum += sum;
+    return time;
+  }
+
+}
+
+int main(int argc, char *argv[]) {
+  std::size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 4000000;
+
+  if (count == 0) {
+    std::fprintf(stderr, "Usage: %s [count]\n", argv[0]);
+    return 1;
+  }
+
+  std::vector<game::EventType> types;
+
+  for (std::size_t i = 0; i < TYPES; ++i) {
+    types.push_back(game::Hash("BenchEvent" + std::to_string(i)));
+  }
+
+  game::Random random(42);
+  std::vector<game::EventType> sequence;
+
+  for (std::size_t i = 0; i < count; ++i) {
+    sequence.push_back(types[random.computeUniformInteger(0, TYPES - 1)]);
+  }
+
+  std::printf("%zu events, %zu types, %zu handlers per type\n", count, TYPES, HANDLERS_PER_TYPE);
+
+  // the lookup alone
+
+  game::IdMap<uint64_t> id_map;
+  std::map<game::EventType, uint64_t> tree_map;
+  std::unordered_map<game::EventType, uint64_t> hash_map;
+
+  for (std::size_t i = 0; i < TYPES; ++i) {
+    id_map[types[i]] = i;
+    tree_map[types[i]] = i;
+    hash_map[types[i]] = i;
+  }
+
+  uint64_t id_sum = 0;
+  double id_time = measure(count, [&]() {
+    for (auto type : sequence) {
+      id_sum += *id_map.find(type);
+    }
+  });
+
+  g_sum += id_sum;
+
+  std::printf("lookup, IdMap:              %6.2f ns/event\n", id_time);
+  std::printf("lookup, std::map:           %6.2f ns/event\n", lookup(sequence, tree_map));
+  std::printf("lookup, std::unordered_map: %6.2f ns/event\n", lookup(sequence, hash_map));
+
+  // the whole dispatch
+
+  game::EventManager events;
+
+  for (auto type : types) {
+    for (std::size_t i = 0; i < HANDLERS_PER_TYPE; ++i) {
+      events.registerHandler(type, &onEvent);
+    }
+  }
+
+  BenchEvent event;
+  event.value = 1;
+
+  double dispatch_time = measure(count, [&]() {
+    for (auto type : sequence) {
+      events.triggerEvent(type, &event);
+    }
+  });
+
+  std::printf("EventManager::triggerEvent: %6.2f ns/event\n", dispatch_time);
+
+  // keep the sums alive
+  return g_sum == 0 ? 1 : 0;
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2014-2015, Julien Bernard
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include "game/JobSystem.h"
+
+/*
+ * Time a synthetic parallelFor with 0 to N-1 workers, where N is the number
+ * of hardware threads (or the second argument). The calling thread takes part in the work, so the
+ * number of cores used is the number of workers plus one.
+ */
+
+static constexpr int ROUNDS = 10;
+
+namespace {
+
+  // some floating point work that the compiler can not remove
+  float compute(std::size_t index) {
+    float x = static_cast<float>(index % 1000) * 0.001f;
+
+    for (int i = 0; i < 200; ++i) {
+      x = std::sin(x) * 0.5f + std::cos(x) * 0.5f;
+    }
+
+    return x;
+  }
+
+  double run(unsigned workers, std::vector<float>& output) {
+    game::JobSystem jobs(workers);
+
+    // warm the workers up
+    jobs.parallelFor(output.size(), [&output](std::size_t i) {
+      output[i] = 0.0f;
+    });
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (int round = 0; round < ROUNDS; ++round) {
+      jobs.parallelFor(output.size(), [&output](std::size_t i) {
+        output[i] = compute(i);
+      });
+    }
+
+    std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - start;
+    return duration.count() / ROUNDS;
+  }
+
+}
+
+int main(int argc, char *argv[]) {
+  std::size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+  unsigned cores = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : std::max(std::thread::hardware_concurrency(), 1u);
+
+  if (count == 0 || cores == 0) {
+    std::fprintf(stderr, "Usage: %s [count] [cores]\n", argv[0]);
+    return 1;
+  }
+
+  std::printf("parallelFor over %zu indices, up to %u cores\n", count, cores);
+
+  std::vector<float> expected(count);
+  double reference = run(0, expected);
+  std::printf("%2u cores: %8.2f ms, speedup: %5.2fx\n", 1u, reference, 1.0);
+
+  for (unsigned workers = 1; workers < cores; ++workers) {
+    std::vector<float> output(count);
+    double time = run(workers, output);
+
+    if (output != expected) {
+      std::fprintf(stderr, "The results differ with %u workers\n", workers);
+      return 1;
+    }
+
+    std::printf("%2u cores: %8.2f ms, speedup: %5.2fx\n", workers + 1, time, reference / time);
+  }
+
+  return 0;
+}
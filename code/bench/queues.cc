@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2014-2015, Julien Bernard
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+#include "game/MpmcQueue.h"
+#include "game/Queue.h"
+#include "game/SpscQueue.h"
+
+/*
+ * Transfer integers from one producer thread to one consumer thread, with
+ * the mutex Queue, the lock-free SpscQueue and the lock-free MpmcQueue, and
+ * print the throughput of each queue.
+ */
+
+static constexpr std::size_t CAPACITY = 1024;
+
+namespace {
+
+  // the bounded queues fail when they are full or empty, the thread retries
+  template<typename Push, typename Poll>
+  double transfer(uint64_t count, Push push, Poll poll) {
+    uint64_t sum = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    std::thread consumer([count, &sum, &poll]() {
+      for (uint64_t i = 0; i < count; ++i) {
+        uint64_t value;
+
+        while (!poll(value)) {
+          std::this_thread::yield();
+        }
+
+        sum += value;
+      }
+    });
+
+    for (uint64_t i = 0; i < count; ++i) {
+      while (!push(i)) {
+        std::this_thread::yield();
+      }
+    }
+
+    consumer.join();
+    std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+
+    if (sum != count * (count - 1) / 2) {
+      std::fprintf(stderr, "Some values were lost\n");
+      std::exit(1);
+    }
+
+    return count / duration.count() / 1e6;
+  }
+
+}
+
+int main(int argc, char *argv[]) {
+  uint64_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+
+  if (count == 0) {
+    std::fprintf(stderr, "Usage: %s [count]\n", argv[0]);
+    return 1;
+  }
+
+  std::printf("%llu values, 1 producer, 1 consumer\n", static_cast<unsigned long long>(count));
+
+  game::Queue<uint64_t> queue;
+  double mutex = transfer(count, [&queue](uint64_t value) {
+    queue.push(value);
+    return true;
+  }, [&queue](uint64_t& value) {
+    return queue.poll(value);
+  });
+
+  std::printf("Queue:     %8.2f Mvalues/s\n", mutex);
+
+  game::SpscQueue<uint64_t> spsc(CAPACITY);
+  double lock_free = transfer(count, [&spsc](uint64_t value) {
+    return spsc.push(value);
+  }, [&spsc](uint64_t& value) {
+    return spsc.poll(value);
+  });
+
+  std::printf("SpscQueue: %8.2f Mvalues/s (%.1fx)\n", lock_free, lock_free / mutex);
+
+  game::MpmcQueue<uint64_t> mpmc(CAPACITY);
+  double bounded = transfer(count, [&mpmc](uint64_t value) {
+    return mpmc.tryPush(value);
+  }, [&mpmc](uint64_t& value) {
+    return mpmc.tryPop(value);
+  });
+
+  std::printf("MpmcQueue: %8.2f Mvalues/s (%.1fx)\n", bounded, bounded / mutex);
+  return 0;
+}
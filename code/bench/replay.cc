@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2014-2015, Julien Bernard
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include <boost/filesystem.hpp>
+
+#include "game/EventManager.h"
+#include "game/EventRecorder.h"
+#include "game/EventReplayer.h"
+#include "game/Random.h"
+
+/*
+ * Record a synthetic session of events in a trace, then replay the trace
+ * headless, as fast as possible, with EventReplayer::replayAll(). The
+ * events are posted (and one type is triggered) while recording, and they
+ * are replayed through the same paths. The handlers must see the same
+ * events in both runs.
+ */
+
+static constexpr std::size_t EVENTS_PER_FRAME = 100;
+
+namespace {
+
+  struct MoveEvent : public game::Event {
+    static const game::EventType type = "BenchMoveEvent"_type;
+    float dx;
+    float dy;
+  };
+
+  struct HitEvent : public game::Event {
+    static const game::EventType type = "BenchHitEvent"_type;
+    uint32_t target;
+    int32_t damage;
+  };
+
+  struct TickEvent : public game::Event {
+    static const game::EventType type = "BenchTickEvent"_type;
+    uint64_t frame;
+  };
+
+  struct Totals {
+    Totals()
+    : moves(0.0)
+    , damage(0)
+    , ticks(0)
+    , events(0)
+    {
+    }
+
+    double moves;
+    int64_t damage;
+    uint64_t ticks;
+    uint64_t events;
+  };
+
+  void registerHandlers(game::EventManager& events, Totals& totals) {
+    events.registerTypedHandler<MoveEvent>([&totals](const MoveEvent& event) {
+      totals.moves += event.dx + event.dy;
+      ++totals.events;
+      return game::EventStatus::KEEP;
+    });
+
+    events.registerTypedHandler<HitEvent>([&totals](const HitEvent& event) {
+      totals.damage += event.damage;
+      ++totals.events;
+      return game::EventStatus::KEEP;
+    });
+
+    events.registerTypedHandler<TickEvent>([&totals](const TickEvent& event) {
+      totals.ticks += event.frame;
+      ++totals.events;
+      return game::EventStatus::KEEP;
+    });
+  }
+
+}
+
+int main(int argc, char *argv[]) {
+  std::size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+
+  if (count == 0) {
+    std::fprintf(stderr, "Usage: %s [count]\n", argv[0]);
+    return 1;
+  }
+
+  boost::filesystem::path trace = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("game-%%%%-%%%%.trace");
+
+  // record
+
+  Totals recorded;
+  game::EventRecorder recorder;
+
+  if (!recorder.open(trace.string())) {
+    return 1;
+  }
+
+  {
+    game::EventManager events;
+    events.setRecorder(&recorder);
+    registerHandlers(events, recorded);
+
+    game::Random random(42);
+
+    for (std::size_t i = 0; i < count; ++i) {
+      if (random.computeBernoulli(0.7f)) {
+        MoveEvent event;
+        event.dx = random.computeUniformFloat(-1.0f, 1.0f);
+        event.dy = random.computeUniformFloat(-1.0f, 1.0f);
+        events.postEvent(event);
+      } else {
+        HitEvent event;
+        event.target = random.computeUniformInteger(0, 1000);
+        event.damage = random.computeUniformInteger(1, 100);
+        events.postEvent(event);
+      }
+
+      if ((i + 1) % EVENTS_PER_FRAME == 0) {
+        TickEvent event;
+        event.frame = i / EVENTS_PER_FRAME;
+        events.triggerEvent(&event);
+        events.dispatchQueued();
+      }
+    }
+
+    events.dispatchQueued();
+  }
+
+  recorder.close();
+
+  // replay
+
+  Totals replayed;
+  game::EventReplayer replayer;
+
+  if (!replayer.loadFromFile(trace.string())) {
+    boost::filesystem::remove(trace);
+    return 1;
+  }
+
+  game::EventManager events;
+  registerHandlers(events, replayed);
+
+  replayer.replayQueuedTo<MoveEvent>(events);
+  replayer.replayQueuedTo<HitEvent>(events);
+  replayer.replayTo<TickEvent>(events);
+
+  auto start = std::chrono::steady_clock::now();
+  std::size_t records = replayer.replayAll();
+  events.dispatchQueued();
+  std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+
+  boost::system::error_code ec;
+  std::size_t size = boost::filesystem::file_size(trace, ec);
+  boost::filesystem::remove(trace, ec);
+
+  if (replayed.events != recorded.events || replayed.moves != recorded.moves || replayed.damage != recorded.damage || replayed.ticks != recorded.ticks) {
+    std::fprintf(stderr, "The replay differs from the recorded session\n");
+    return 1;
+  }
+
+  std::printf("%zu records (%zu bytes), replayed in %.3f s: %.2f Mrecords/s\n", records, size, duration.count(), records / duration.count() / 1e6);
+  return 0;
+}
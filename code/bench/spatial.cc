@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) 2014-2015, Julien Bernard
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <vector>
+
+#include "game/Random.h"
+#include "game/SpatialGrid.h"
+
+/*
+ * Compare the queries of a SpatialGrid with a brute force scan of all the
+ * entities, at 1k, 10k and 100k entities. The results of the grid are
+ * checked against the results of the brute force.
+ */
+
+static constexpr float CELL_SIZE = 32.0f;
+static constexpr float RADIUS = 32.0f;
+static constexpr std::size_t NEAREST = 8;
+static constexpr int QUERIES = 1000;
+
+namespace {
+
+  struct Scene {
+    std::vector<game::Vector2f> positions; // indexed by the handle index
+    game::SpatialGrid grid;
+
+    Scene()
+    : grid(CELL_SIZE)
+    {
+    }
+  };
+
+  struct Query {
+    game::Vector2f center;
+    game::Vector2f min;
+    game::Vector2f max;
+  };
+
+  float squaredDistance(const game::Vector2f& lhs, const game::Vector2f& rhs) {
+    game::Vector2f d = lhs - rhs;
+    return game::dotProduct(d, d);
+  }
+
+  void bruteRadius(const Scene& scene, const Query& query, std::vector<game::EntityHandle>& result) {
+    for (std::size_t i = 0; i < scene.positions.size(); ++i) {
+      if (squaredDistance(scene.positions[i], query.center) <= RADIUS * RADIUS) {
+        result.push_back(game::EntityHandle(i, 1));
+      }
+    }
+  }
+
+  void bruteRect(const Scene& scene, const Query& query, std::vector<game::EntityHandle>& result) {
+    for (std::size_t i = 0; i < scene.positions.size(); ++i) {
+      const game::Vector2f& pos = scene.positions[i];
+
+      if (query.min.x <= pos.x && pos.x <= query.max.x && query.min.y <= pos.y && pos.y <= query.max.y) {
+        result.push_back(game::EntityHandle(i, 1));
+      }
+    }
+  }
+
+  void bruteNearest(const Scene& scene, const Query& query, std::vector<game::EntityHandle>& result) {
+    std::vector<std::pair<float, uint32_t>> candidates;
+
+    for (std::size_t i = 0; i < scene.positions.size(); ++i) {
+      candidates.push_back(std::make_pair(squaredDistance(scene.positions[i], query.center), i));
+    }
+
+    std::size_t count = std::min(NEAREST, candidates.size());
+    std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end());
+
+    for (std::size_t i = 0; i < count; ++i) {
+      result.push_back(game::EntityHandle(candidates[i].second, 1));
+    }
+  }
+
+  void gridRadius(const Scene& scene, const Query& query, std::vector<game::EntityHandle>& result) {
+    scene.grid.queryRadius(query.center, RADIUS, result);
+  }
+
+  void gridRect(const Scene& scene, const Query& query, std::vector<game::EntityHandle>& result) {
+    scene.grid.queryRect(query.min, query.max, result);
+  }
+
+  void gridNearest(const Scene& scene, const Query& query, std::vector<game::EntityHandle>& result) {
+    scene.grid.queryNearest(query.center, NEAREST, result);
+  }
+
+  typedef void (*QueryFunc)(const Scene&, const Query&, std::vector<game::EntityHandle>&);
+
+  double run(const Scene& scene, const std::vector<Query>& queries, QueryFunc func, std::vector<std::vector<game::EntityHandle>>& results) {
+    results.resize(queries.size());
+    auto start = std::chrono::steady_clock::now();
+
+    for (std::size_t i = 0; i < queries.size(); ++i) {
+      results[i].clear();
+      func(scene, queries[i], results[i]);
+    }
+
+    std::chrono::duration<double, std::micro> duration = std::chrono::steady_clock::now() - start;
+    return duration.count() / queries.size();
+  }
+
+  // the nearest entities may differ on ties, so their distances are compared
+  std::vector<float> getDistances(const Scene& scene, const Query& query, const std::vector<game::EntityHandle>& result) {
+    std::vector<float> distances;
+
+    for (auto h : result) {
+      distances.push_back(squaredDistance(scene.positions[h.index], query.center));
+    }
+
+    std::sort(distances.begin(), distances.end());
+    return distances;
+  }
+
+  bool check(const char *name, const Scene& scene, const std::vector<Query>& queries, QueryFunc brute, QueryFunc grid, bool nearest) {
+    std::vector<std::vector<game::EntityHandle>> expected;
+    std::vector<std::vector<game::EntityHandle>> actual;
+
+    double brute_time = run(scene, queries, brute, expected);
+    double grid_time = run(scene, queries, grid, actual);
+
+    for (std::size_t i = 0; i < queries.size(); ++i) {
+      if (nearest) {
+        if (getDistances(scene, queries[i], expected[i]) != getDistances(scene, queries[i], actual[i])) {
+          std::fprintf(stderr, "%s: mismatch for query %zu\n", name, i);
+          return false;
+        }
+      } else {
+        auto compare = [](const game::EntityHandle& lhs, const game::EntityHandle& rhs) {
+          return lhs.index < rhs.index;
+        };
+
+        std::sort(expected[i].begin(), expected[i].end(), compare);
+        std::sort(actual[i].begin(), actual[i].end(), compare);
+
+        if (expected[i] != actual[i]) {
+          std::fprintf(stderr, "%s: mismatch for query %zu\n", name, i);
+          return false;
+        }
+      }
+    }
+
+    std::printf("  %-8s brute force: %10.2f us/query, grid: %8.2f us/query, speedup: %7.1fx\n", name, brute_time, grid_time, brute_time / grid_time);
+    return true;
+  }
+
+}
+
+int main() {
+  game::Random random(42);
+
+  for (std::size_t count : { 1000, 10000, 100000 }) {
+    // about the same density for all the counts
+    float size = std::sqrt(static_cast<float>(count)) * CELL_SIZE / 2.0f;
+
+    Scene scene;
+
+    for (std::size_t i = 0; i < count; ++i) {
+      game::Vector2f position = { random.computeUniformFloat(0.0f, size), random.computeUniformFloat(0.0f, size) };
+      scene.positions.push_back(position);
+      scene.grid.addEntity(game::EntityHandle(i, 1), position);
+    }
+
+    // move every entity, to check the incremental updates
+    for (std::size_t i = 0; i < count; ++i) {
+      game::Vector2f& position = scene.positions[i];
+      position.x += random.computeUniformFloat(-2.0f * CELL_SIZE, 2.0f * CELL_SIZE);
+      position.y += random.computeUniformFloat(-2.0f * CELL_SIZE, 2.0f * CELL_SIZE);
+      scene.grid.moveEntity(game::EntityHandle(i, 1), position);
+    }
+
+    std::vector<Query> queries;
+
+    for (int i = 0; i < QUERIES; ++i) {
+      Query query;
+      query.center = { random.computeUniformFloat(0.0f, size), random.computeUniformFloat(0.0f, size) };
+      query.min = { query.center.x - 2.0f * RADIUS, query.center.y - RADIUS };
+      query.max = { query.center.x + 2.0f * RADIUS, query.center.y + RADIUS };
+      queries.push_back(query);
+    }
+
+    std::printf("%zu entities\n", count);
+
+    if (!check("radius", scene, queries, &bruteRadius, &gridRadius, false)
+        || !check("rect", scene, queries, &bruteRect, &gridRect, false)
+        || !check("nearest", scene, queries, &bruteNearest, &gridNearest, true)) {
+      return 1;
+    }
+  }
+
+  return 0;
+}
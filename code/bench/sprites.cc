@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2014-2015, Julien Bernard
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#include <SFML/Graphics.hpp>
+
+#include "game/Random.h"
+#include "game/SpriteBatch.h"
+
+/*
+ * Draw N sprites that use K textures, once sprite by sprite and once in a
+ * SpriteBatch, and print the number of draw calls and the time of a frame.
+ * The textures of consecutive sprites differ, which is the worst case for
+ * the direct path.
+ */
+
+static constexpr int FRAMES = 60;
+
+template<typename Func>
+static double timeFrames(sf::RenderWindow& window, Func func) {
+  auto start = std::chrono::steady_clock::now();
+
+  for (int i = 0; i < FRAMES; ++i) {
+    window.clear();
+    func();
+    window.display();
+  }
+
+  std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - start;
+  return duration.count() / FRAMES;
+}
+
+int main(int argc, char *argv[]) {
+  std::size_t sprite_count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10000;
+  std::size_t texture_count = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 8;
+
+  if (sprite_count == 0 || texture_count == 0) {
+    std::fprintf(stderr, "Usage: %s [sprites] [textures]\n", argv[0]);
+    return 1;
+  }
+
+  sf::RenderWindow window(sf::VideoMode(800, 600), "game_bench_sprites");
+  window.setVerticalSyncEnabled(false);
+
+  std::vector<std::unique_ptr<sf::Texture>> textures;
+  game::Random random(42);
+
+  for (std::size_t i = 0; i < texture_count; ++i) {
+    sf::Image image;
+    image.create(32, 32, sf::Color(random.computeUniformInteger(0, 255), random.computeUniformInteger(0, 255), random.computeUniformInteger(0, 255)));
+
+    std::unique_ptr<sf::Texture> texture(new sf::Texture);
+
+    if (!texture->loadFromImage(image)) {
+      std::fprintf(stderr, "Could not create the textures\n");
+      return 1;
+    }
+
+    textures.push_back(std::move(texture));
+  }
+
+  std::vector<sf::Sprite> sprites;
+
+  for (std::size_t i = 0; i < sprite_count; ++i) {
+    sf::Sprite sprite(*textures[i % texture_count]);
+    sprite.setPosition(random.computeUniformFloat(0.0f, 800.0f), random.computeUniformFloat(0.0f, 600.0f));
+    sprites.push_back(sprite);
+  }
+
+  std::printf("%zu sprites, %zu textures, %d frames\n", sprite_count, texture_count, FRAMES);
+
+  double direct = timeFrames(window, [&]() {
+    for (auto& sprite : sprites) {
+      window.draw(sprite);
+    }
+  });
+
+  // one draw call per sprite
+  std::printf("direct:  %8zu draw calls/frame, %8.3f ms/frame\n", sprites.size(), direct);
+
+  game::SpriteBatch batch(window);
+
+  double batched = timeFrames(window, [&]() {
+    for (auto& sprite : sprites) {
+      batch.draw(sprite);
+    }
+
+    batch.flush();
+  });
+
+  std::printf("batched: %8zu draw calls/frame, %8.3f ms/frame\n", batch.getDrawCallCount() / FRAMES, batched);
+  return 0;
+}
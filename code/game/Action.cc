@@ -22,6 +22,10 @@
 #include "Action.h"
 
 #include <cassert>
+#include <cstring>
+
+#include "EventRecorder.h"
+#include "EventReplayer.h"
 
 namespace game {
 
@@ -99,11 +103,22 @@ namespace game {
 
   // ActionManager
 
+  constexpr EventType ActionManager::RECORDED_EVENT;
+
+  ActionManager::ActionManager()
+  : m_recorder(nullptr)
+  {
+  }
+
   void ActionManager::addAction(Action& action) {
     m_actions.push_back(&action);
   }
 
   void ActionManager::update(const sf::Event& event) {
+    if (m_recorder != nullptr) {
+      m_recorder->record(RECORDED_EVENT, &event, sizeof(sf::Event));
+    }
+
     for (auto action : m_actions) {
       action->update(event);
     }
@@ -115,4 +130,17 @@ namespace game {
     }
   }
 
+  void ActionManager::setRecorder(EventRecorder *recorder) {
+    m_recorder = recorder;
+  }
+
+  void ActionManager::replayFrom(EventReplayer& replayer) {
+    replayer.setHandler(RECORDED_EVENT, [this](const void *data, std::size_t size) {
+      assert(size == sizeof(sf::Event));
+      sf::Event event;
+      std::memcpy(&event, data, sizeof(sf::Event));
+      update(event);
+    });
+  }
+
 }
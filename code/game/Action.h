@@ -26,9 +26,13 @@
 #include <vector>
 
 #include "Control.h"
+#include "Event.h"
 
 namespace game {
 
+  class EventRecorder;
+  class EventReplayer;
+
   /**
    * @brief An action that can be triggered by different controls.
    *
@@ -195,6 +199,13 @@ namespace game {
    */
   class ActionManager {
   public:
+    /**
+     * @brief The type of the recorded SFML events.
+     */
+    static constexpr EventType RECORDED_EVENT = "sf::Event"_type;
+
+    ActionManager();
+
     /**
      * @brief Add an action.
      *
@@ -218,8 +229,26 @@ namespace game {
      */
     void reset();
 
+    /**
+     * @brief Set a recorder for the events.
+     *
+     * The events given to update() are recorded with the type
+     * RECORDED_EVENT.
+     *
+     * @param recorder the recorder, or @c nullptr to stop recording
+     */
+    void setRecorder(EventRecorder *recorder);
+
+    /**
+     * @brief Update the actions with the events of a trace.
+     *
+     * @param replayer the replayer of the trace
+     */
+    void replayFrom(EventReplayer& replayer);
+
   private:
     std::vector<Action*> m_actions;
+    EventRecorder *m_recorder;
   };
 
 }
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2014-2015, Julien Bernard
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#include "ActorStore.h"
+
+#include <cassert>
+
+namespace game {
+
+  ActorHandle ActorStore::addActor(const Vector2f& position, const Vector2f& velocity, uint32_t sprite) {
+    uint32_t index;
+
+    if (m_free.empty()) {
+      index = m_slots.size();
+      m_slots.push_back({ 1, 0 });
+    } else {
+      index = m_free.back();
+      m_free.pop_back();
+    }
+
+    Slot& slot = m_slots[index];
+    slot.index = m_positions.size();
+
+    m_positions.push_back(position);
+    m_velocities.push_back(velocity);
+    m_sprites.push_back(sprite);
+    m_owners.push_back(index);
+
+    return ActorHandle(index, slot.generation);
+  }
+
+  bool ActorStore::removeActor(ActorHandle h) {
+    if (!hasActor(h)) {
+      return false;
+    }
+
+    Slot& slot = m_slots[h.index];
+    uint32_t last = m_positions.size() - 1;
+
+    // move the last actor in the hole
+    if (slot.index != last) {
+      m_positions[slot.index] = m_positions[last];
+      m_velocities[slot.index] = m_velocities[last];
+      m_sprites[slot.index] = m_sprites[last];
+      m_owners[slot.index] = m_owners[last];
+      m_slots[m_owners[last]].index = slot.index;
+    }
+
+    m_positions.pop_back();
+    m_velocities.pop_back();
+    m_sprites.pop_back();
+    m_owners.pop_back();
+
+    // the generation 0 is never valid
+    if (++slot.generation == 0) {
+      slot.generation = 1;
+    }
+
+    m_free.push_back(h.index);
+    return true;
+  }
+
+  bool ActorStore::hasActor(ActorHandle h) const {
+    return h.index < m_slots.size() && m_slots[h.index].generation == h.generation;
+  }
+
+  std::size_t ActorStore::getIndex(ActorHandle h) const {
+    assert(hasActor(h));
+    return m_slots[h.index].index;
+  }
+
+  void ActorStore::update(float dt) {
+    std::size_t count = m_positions.size();
+    Vector2f *positions = m_positions.data();
+    const Vector2f *velocities = m_velocities.data();
+
+    for (std::size_t i = 0; i < count; ++i) {
+      positions[i] += velocities[i] * dt;
+    }
+  }
+
+  void ActorStore::render(sf::RenderWindow& window, const sf::Texture& texture, const std::vector<sf::IntRect>& sprites) {
+    std::size_t count = m_positions.size();
+    m_vertices.resize(count * 4);
+
+    for (std::size_t i = 0; i < count; ++i) {
+      assert(m_sprites[i] < sprites.size());
+      const sf::IntRect& rect = sprites[m_sprites[i]];
+      const Vector2f& pos = m_positions[i];
+
+      float x = pos.x - rect.width * 0.5f;
+      float y = pos.y - rect.height * 0.5f;
+      float u = rect.left;
+      float v = rect.top;
+
+      sf::Vertex *quad = &m_vertices[i * 4];
+      quad[0].position = { x, y };
+      quad[0].texCoords = { u, v };
+      quad[1].position = { x + rect.width, y };
+      quad[1].texCoords = { u + rect.width, v };
+      quad[2].position = { x + rect.width, y + rect.height };
+      quad[2].texCoords = { u + rect.width, v + rect.height };
+      quad[3].position = { x, y + rect.height };
+      quad[3].texCoords = { u, v + rect.height };
+    }
+
+    window.draw(m_vertices.data(), m_vertices.size(), sf::Quads, &texture);
+  }
+
+}
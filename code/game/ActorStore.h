@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2014-2015, Julien Bernard
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#ifndef GAME_ACTOR_STORE_H
+#define GAME_ACTOR_STORE_H
+
+#include <cstdint>
+#include <vector>
+
+#include <SFML/Graphics.hpp>
+
+#include "Handle.h"
+#include "Vector.h"
+
+namespace game {
+
+  class ActorStore;
+
+  /**
+   * @ingroup graphics
+   */
+  typedef Handle<ActorStore> ActorHandle;
+
+  /**
+   * @brief A packed storage for simple actors.
+   *
+   * This is a data-oriented alternative to Entity for large numbers of
+   * simple actors. An actor is only made of a position, a velocity and a
+   * sprite index. Each component is stored in its own packed array (struct
+   * of arrays), so that a system can iterate over the components it needs
+   * without any indirection:
+   *
+   * ~~~{.cc}
+   * game::Vector2f *velocities = store.getVelocities();
+   *
+   * for (std::size_t i = 0; i < store.getActorCount(); ++i) {
+   *   velocities[i].y += GRAVITY * dt;
+   * }
+   * ~~~
+   *
+   * The actors are referenced by generational handles. A removal moves the
+   * last actor in place of the removed one, so the order of the actors in
+   * the arrays is not stable.
+   *
+   * @ingroup graphics
+   */
+  class ActorStore {
+  public:
+    /**
+     * @brief Add an actor.
+     *
+     * @param position the initial position of the actor
+     * @param velocity the initial velocity of the actor
+     * @param sprite the index of the sprite of the actor
+     * @returns a handle to the actor
+     */
+    ActorHandle addActor(const Vector2f& position, const Vector2f& velocity, uint32_t sprite);
+
+    /**
+     * @brief Remove an actor.
+     *
+     * @param h the handle of the actor
+     * @returns true if the actor has been removed
+     */
+    bool removeActor(ActorHandle h);
+
+    /**
+     * @brief Tell whether a handle references an actor of the store.
+     *
+     * @param h the handle of the actor
+     * @returns true if the handle is not stale
+     */
+    bool hasActor(ActorHandle h) const;
+
+    /**
+     * @brief Get the index of an actor in the packed arrays.
+     *
+     * The index is valid until the next removal.
+     *
+     * @param h the handle of the actor (must not be stale)
+     * @returns the index of the actor
+     */
+    std::size_t getIndex(ActorHandle h) const;
+
+    std::size_t getActorCount() const {
+      return m_positions.size();
+    }
+
+    /**
+     * @name Packed arrays
+     * @{
+     */
+    Vector2f *getPositions() {
+      return m_positions.data();
+    }
+
+    const Vector2f *getPositions() const {
+      return m_positions.data();
+    }
+
+    Vector2f *getVelocities() {
+      return m_velocities.data();
+    }
+
+    const Vector2f *getVelocities() const {
+      return m_velocities.data();
+    }
+
+    uint32_t *getSprites() {
+      return m_sprites.data();
+    }
+
+    const uint32_t *getSprites() const {
+      return m_sprites.data();
+    }
+    /** @} */
+
+    /**
+     * @brief Move all the actors according to their velocity.
+     *
+     * @param dt the elapsed time
+     */
+    void update(float dt);
+
+    /**
+     * @brief Render all the actors in a single draw call.
+     *
+     * The sprite index of an actor is an index in the @c sprites vector.
+     * The sprites are centered on the position of the actors.
+     *
+     * @param window the window
+     * @param texture the texture atlas of all the sprites
+     * @param sprites the rectangles of the sprites in the atlas
+     */
+    void render(sf::RenderWindow& window, const sf::Texture& texture, const std::vector<sf::IntRect>& sprites);
+
+  private:
+    struct Slot {
+      uint32_t generation;
+      uint32_t index; // in the packed arrays
+    };
+
+    std::vector<Slot> m_slots;
+    std::vector<uint32_t> m_free;
+
+    // packed arrays
+    std::vector<Vector2f> m_positions;
+    std::vector<Vector2f> m_velocities;
+    std::vector<uint32_t> m_sprites;
+    std::vector<uint32_t> m_owners; // slot of each actor
+
+    std::vector<sf::Vertex> m_vertices;
+  };
+
+}
+
+#endif // GAME_ACTOR_STORE_H
@@ -55,20 +55,37 @@ namespace game {
   }
 
   void Animation::renderAt(sf::RenderWindow& window, const sf::Vector2f& position, float angle) const {
+    sf::Sprite sprite;
+
+    if (setupSprite(sprite, position, angle)) {
+      window.draw(sprite);
+    }
+  }
+
+  void Animation::renderAt(SpriteBatch& batch, const sf::Vector2f& position, float angle) const {
+    sf::Sprite sprite;
+
+    if (setupSprite(sprite, position, angle)) {
+      batch.draw(sprite);
+    }
+  }
+
+  bool Animation::setupSprite(sf::Sprite& sprite, const sf::Vector2f& position, float angle) const {
     if (m_frames.empty()) {
       Log::error(Log::GRAPHICS, "The animation does not have any frame: %s\n", m_name.c_str());
-      return;
+      return false;
     }
 
     const Frame& frame = m_frames[m_current_frame];
-    sf::Sprite sprite(*frame.texture, frame.bounds);
+    sprite.setTexture(*frame.texture);
+    sprite.setTextureRect(frame.bounds);
 
     sf::FloatRect bounds = sprite.getLocalBounds();
     sprite.setOrigin(bounds.width * 0.5, bounds.height * 0.5);
 
     sprite.setPosition(position);
     sprite.setRotation(angle);
-    window.draw(sprite);
+    return true;
   }
 
 }
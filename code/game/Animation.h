@@ -26,6 +26,8 @@
 
 #include <SFML/Graphics.hpp>
 
+#include "SpriteBatch.h"
+
 namespace game {
 
   /**
@@ -46,6 +48,10 @@ namespace game {
 
     void update(float dt);
     void renderAt(sf::RenderWindow& window, const sf::Vector2f& position, float angle = 0.0f) const;
+    void renderAt(SpriteBatch& batch, const sf::Vector2f& position, float angle = 0.0f) const;
+
+  private:
+    bool setupSprite(sf::Sprite& sprite, const sf::Vector2f& position, float angle) const;
 
   private:
     struct Frame {
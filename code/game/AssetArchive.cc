@@ -0,0 +1,233 @@
+/*
+ * Copyright (c) 2014-2015, Julien Bernard
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#include "AssetArchive.h"
+
+#include <cassert>
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <boost/interprocess/exceptions.hpp>
+
+#include "Log.h"
+
+namespace fs = boost::filesystem;
+namespace ipc = boost::interprocess;
+
+namespace game {
+
+  constexpr uint32_t AssetArchive::MAGIC;
+  constexpr uint32_t AssetArchive::VERSION;
+
+  AssetArchive::AssetArchive()
+  : m_index(nullptr)
+  , m_count(0)
+  {
+  }
+
+  bool AssetArchive::open(const boost::filesystem::path& path) {
+    ipc::file_mapping file;
+    ipc::mapped_region region;
+
+    try {
+      file = ipc::file_mapping(path.string().c_str(), ipc::read_only);
+      region = ipc::mapped_region(file, ipc::read_only);
+    } catch (const ipc::interprocess_exception& ex) {
+      Log::error(Log::RESOURCES, "Could not map the archive: %s (%s)\n", path.string().c_str(), ex.what());
+      return false;
+    }
+
+    const char *data = static_cast<const char *>(region.get_address());
+    std::size_t size = region.get_size();
+
+    const Header *header = reinterpret_cast<const Header *>(data);
+
+    if (size < sizeof(Header) || header->magic != MAGIC || header->version != VERSION
+        || header->count > (size - sizeof(Header)) / sizeof(IndexEntry)) {
+      Log::error(Log::RESOURCES, "Not an archive of assets: %s\n", path.string().c_str());
+      return false;
+    }
+
+    m_file.swap(file);
+    m_region.swap(region);
+    m_index = reinterpret_cast<const IndexEntry *>(data + sizeof(Header));
+    m_count = header->count;
+
+    Log::info(Log::RESOURCES, "Opened an archive of %zu assets: %s\n", m_count, path.string().c_str());
+    return true;
+  }
+
+  const char *AssetArchive::findAsset(const boost::filesystem::path& relative_path, std::size_t& size) const {
+    Id hash = Hash(relative_path.generic_string());
+
+    const IndexEntry *end = m_index + m_count;
+    const IndexEntry *entry = std::lower_bound(m_index, end, hash, [](const IndexEntry& lhs, Id rhs) {
+      return lhs.hash < rhs;
+    });
+
+    if (entry == end || entry->hash != hash) {
+      return nullptr;
+    }
+
+    if (entry->offset > m_region.get_size() || entry->size > m_region.get_size() - entry->offset) {
+      Log::error(Log::RESOURCES, "The asset is out of the archive: %s\n", relative_path.string().c_str());
+      return nullptr;
+    }
+
+    size = entry->size;
+    return static_cast<const char *>(m_region.get_address()) + entry->offset;
+  }
+
+  bool AssetArchive::pack(const boost::filesystem::path& directory, const boost::filesystem::path& path) {
+    struct File {
+      IndexEntry entry;
+      fs::path path;
+    };
+
+    std::vector<File> files;
+    boost::system::error_code ec;
+
+    // do not pack a previous version of the archive
+    bool previous = fs::exists(path, ec);
+
+    for (fs::recursive_directory_iterator it(directory, ec), end; !ec && it != end; it.increment(ec)) {
+      fs::file_status status = it->status(ec);
+
+      if (ec) {
+        break;
+      }
+
+      if (!fs::is_regular_file(status)) {
+        continue;
+      }
+
+      if (previous && fs::equivalent(it->path(), path, ec)) {
+        continue;
+      }
+
+      std::string key = fs::relative(it->path(), directory, ec).generic_string();
+
+      if (ec) {
+        break;
+      }
+
+      uint64_t size = fs::file_size(it->path(), ec);
+
+      if (ec) {
+        break;
+      }
+
+      IndexEntry entry = { Hash(key), 0, size };
+      files.push_back({ entry, it->path() });
+    }
+
+    if (ec) {
+      Log::error(Log::RESOURCES, "Could not scan the directory: %s (%s)\n", directory.string().c_str(), ec.message().c_str());
+      return false;
+    }
+
+    std::sort(files.begin(), files.end(), [](const File& lhs, const File& rhs) {
+      return lhs.entry.hash < rhs.entry.hash;
+    });
+
+    uint64_t offset = sizeof(Header) + files.size() * sizeof(IndexEntry);
+
+    for (std::size_t i = 0; i < files.size(); ++i) {
+      if (i > 0 && files[i - 1].entry.hash == files[i].entry.hash) {
+        Log::error(Log::RESOURCES, "Two assets have the same hash: %s, %s\n", files[i - 1].path.string().c_str(), files[i].path.string().c_str());
+        return false;
+      }
+
+      files[i].entry.offset = offset;
+      offset += files[i].entry.size;
+    }
+
+    std::FILE *output = std::fopen(path.string().c_str(), "wb");
+
+    if (output == nullptr) {
+      Log::error(Log::RESOURCES, "Could not open the archive: %s\n", path.string().c_str());
+      return false;
+    }
+
+    Header header = { MAGIC, VERSION, files.size() };
+    bool written = std::fwrite(&header, sizeof(Header), 1, output) == 1;
+
+    for (auto& file : files) {
+      if (!written) {
+        break;
+      }
+
+      written = std::fwrite(&file.entry, sizeof(IndexEntry), 1, output) == 1;
+    }
+
+    std::vector<char> buffer;
+
+    for (auto& file : files) {
+      if (!written) {
+        break;
+      }
+
+      std::FILE *input = std::fopen(file.path.string().c_str(), "rb");
+      buffer.resize(file.entry.size);
+
+      if (input == nullptr || std::fread(buffer.data(), 1, buffer.size(), input) != buffer.size()) {
+        Log::error(Log::RESOURCES, "Could not read the asset: %s\n", file.path.string().c_str());
+        written = false;
+      }
+
+      if (input != nullptr) {
+        std::fclose(input);
+      }
+
+      if (!written) {
+        break;
+      }
+
+      if (std::fwrite(buffer.data(), 1, buffer.size(), output) != buffer.size()) {
+        written = false;
+        break;
+      }
+
+      Log::debug(Log::RESOURCES, "Packed an asset: %s\n", file.path.string().c_str());
+    }
+
+    if (std::fclose(output) != 0) {
+      written = false;
+    }
+
+    if (!written) {
+      Log::error(Log::RESOURCES, "Could not write the archive: %s\n", path.string().c_str());
+
+      // remove the partial archive, but not a device
+      if (fs::is_regular_file(path, ec)) {
+        fs::remove(path, ec);
+      }
+
+      return false;
+    }
+
+    Log::info(Log::RESOURCES, "Packed %zu assets in: %s\n", files.size(), path.string().c_str());
+    return true;
+  }
+
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2014-2015, Julien Bernard
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#ifndef GAME_ASSET_ARCHIVE_H
+#define GAME_ASSET_ARCHIVE_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include "Id.h"
+
+namespace game {
+
+  /**
+   * @brief An archive of assets, mapped in memory.
+   *
+   * An archive is made of a header (a magic number, a version and the number
+   * of assets), an index and the data of the assets. The index is sorted by
+   * the hash of the relative path of the asset (with '/' as a separator)
+   * and gives the offset and the size of the data of each asset. The values
+   * are in the native byte order.
+   *
+   * The archive is mapped in memory when it is opened, so an asset is
+   * found with a binary search in the index and its data are read without
+   * a copy (e.g. with `loadFromMemory`).
+   *
+   * @ingroup base
+   */
+  class AssetArchive {
+  public:
+    static constexpr uint32_t MAGIC = 0x4B415047; // "GPAK"
+    static constexpr uint32_t VERSION = 1;
+
+    AssetArchive();
+
+    AssetArchive(const AssetArchive&) = delete;
+    AssetArchive& operator=(const AssetArchive&) = delete;
+
+    /**
+     * @brief Open an archive.
+     *
+     * @param path the path of the archive
+     * @returns true if the archive is valid
+     */
+    bool open(const boost::filesystem::path& path);
+
+    std::size_t getAssetCount() const {
+      return m_count;
+    }
+
+    /**
+     * @brief Find an asset.
+     *
+     * The data stay valid as long as the archive.
+     *
+     * @param relative_path the path of the asset, relative to the root of
+     * the archive
+     * @param size the size of the data of the asset
+     * @returns the data of the asset, or @c nullptr if it is not in the archive
+     */
+    const char *findAsset(const boost::filesystem::path& relative_path, std::size_t& size) const;
+
+    /**
+     * @brief Pack all the files of a directory in an archive.
+     *
+     * @param directory the root of the archive
+     * @param path the path of the archive
+     * @returns true if the archive was written
+     */
+    static bool pack(const boost::filesystem::path& directory, const boost::filesystem::path& path);
+
+  private:
+    struct Header {
+      uint32_t magic;
+      uint32_t version;
+      uint64_t count;
+    };
+
+    struct IndexEntry {
+      Id hash;
+      uint64_t offset;
+      uint64_t size;
+    };
+
+  private:
+    boost::interprocess::file_mapping m_file;
+    boost::interprocess::mapped_region m_region;
+    const IndexEntry *m_index;
+    std::size_t m_count;
+  };
+
+}
+
+#endif // GAME_ASSET_ARCHIVE_H
@@ -31,29 +31,144 @@ namespace fs = boost::filesystem;
 
 namespace game {
 
+  namespace {
+
+    // the key of a relative path in the index, e.g. "./a//b.png" is "a/b.png"
+    std::string computeKey(const fs::path& relative_path) {
+      fs::path key;
+
+      // lexically_normal() keeps a leading "."
+      for (auto& element : relative_path.lexically_normal()) {
+        if (element != ".") {
+          key /= element;
+        }
+      }
+
+      return key.generic_string();
+    }
+
+  }
+
   void AssetManager::addSearchDir(boost::filesystem::path path) {
     Log::info(Log::RESOURCES, "Added a new search directory: %s\n", path.string().c_str());
+    scan(path);
     m_searchdirs.emplace_back(std::move(path));
   }
 
+  void AssetManager::rescan() {
+    m_index.clear();
+    m_missing.clear();
+
+    for (auto& searchdir : m_searchdirs) {
+      scan(searchdir);
+    }
+  }
+
+  bool AssetManager::addArchive(const boost::filesystem::path& path) {
+    std::unique_ptr<AssetArchive> archive(new AssetArchive);
+
+    if (!archive->open(path)) {
+      return false;
+    }
+
+    m_archives.push_back(std::move(archive));
+    return true;
+  }
+
+  const char *AssetManager::findArchivedAsset(const boost::filesystem::path& relative_path, std::size_t& size) const {
+    // the archives are indexed with normalized paths too
+    fs::path key = computeKey(relative_path);
+
+    for (auto& archive : m_archives) {
+      const char *data = archive->findAsset(key, size);
+
+      if (data != nullptr) {
+        return data;
+      }
+    }
+
+    return nullptr;
+  }
+
   boost::filesystem::path AssetManager::getAbsolutePath(const boost::filesystem::path& relative_path) {
     if (relative_path.is_absolute()) {
       assert(fs::is_regular_file(relative_path));
-      Log::info(Log::RESOURCES, "Found a resource file: %s\n", relative_path.string().c_str());
+      Log::debug(Log::RESOURCES, "Found a resource file: %s\n", relative_path.string().c_str());
       return relative_path;
     }
 
-    for (fs::path base : m_searchdirs) {
-      fs::path absolute_path = base / relative_path;
+    std::string key = computeKey(relative_path);
+    auto it = m_index.find(key);
 
-      if (fs::is_regular_file(absolute_path)) {
-        Log::info(Log::RESOURCES, "Found a resource file: %s\n", absolute_path.string().c_str());
-        return absolute_path;
-      }
+    if (it != m_index.end()) {
+      Log::debug(Log::RESOURCES, "Found a resource file: %s\n", it->second.string().c_str());
+      return it->second;
+    }
+
+    if (m_missing.insert(key).second) {
+      Log::error(Log::RESOURCES, "Could not find the following file: %s\n", relative_path.string().c_str());
     }
 
-    Log::error(Log::RESOURCES, "Could not find the following file: %s\n", relative_path.c_str());
     return fs::path();
   }
 
+  void AssetManager::scan(const boost::filesystem::path& searchdir) {
+    std::size_t count = 0;
+
+    // the directories reached through a symlink, to avoid the cycles
+    std::unordered_set<std::string> visited;
+    boost::system::error_code canonical_ec;
+    fs::path root = fs::canonical(searchdir, canonical_ec);
+
+    if (!canonical_ec) {
+      visited.insert(root.string());
+    }
+
+    // the directories to scan, so that an error only skips one directory
+    std::vector<fs::path> pending;
+    pending.push_back(searchdir);
+
+    while (!pending.empty()) {
+      fs::path directory = std::move(pending.back());
+      pending.pop_back();
+
+      boost::system::error_code ec;
+
+      for (fs::directory_iterator it(directory, fs::directory_options::skip_permission_denied, ec), end; !ec && it != end; it.increment(ec)) {
+        boost::system::error_code status_ec;
+        fs::file_status status = it->status(status_ec);
+
+        if (fs::is_directory(status)) {
+          if (fs::is_symlink(it->symlink_status(status_ec))) {
+            fs::path target = fs::canonical(it->path(), canonical_ec);
+
+            if (canonical_ec || !visited.insert(target.string()).second) {
+              continue;
+            }
+          }
+
+          pending.push_back(it->path());
+          continue;
+        }
+
+        if (!fs::is_regular_file(status)) {
+          continue;
+        }
+
+        // the first search directory wins
+        std::string key = computeKey(it->path().lexically_relative(searchdir));
+
+        if (m_index.emplace(std::move(key), it->path()).second) {
+          ++count;
+        }
+      }
+
+      if (ec) {
+        Log::warning(Log::RESOURCES, "Could not scan the directory: %s (%s)\n", directory.string().c_str(), ec.message().c_str());
+      }
+    }
+
+    Log::debug(Log::RESOURCES, "Indexed %zu files in: %s\n", count, searchdir.string().c_str());
+  }
+
 }
@@ -22,24 +22,83 @@
 #ifndef GAME_ASSET_MANAGER_H
 #define GAME_ASSET_MANAGER_H
 
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include <boost/filesystem.hpp>
 
+#include "AssetArchive.h"
+
 namespace game {
 
   /**
+   * @brief A finder of assets in search directories and archives.
+   *
+   * The files of a search directory are indexed when the directory is
+   * added, so finding an asset does not touch the filesystem. The files
+   * added (or removed) afterwards are only found after a rescan().
+   *
    * @ingroup base
    */
   class AssetManager {
   public:
+    /**
+     * @brief Add a search directory and index its files.
+     *
+     * The directories are searched in the order they were added.
+     *
+     * @param path the path of the directory
+     */
     void addSearchDir(boost::filesystem::path path);
 
+    /**
+     * @brief Index the files of the search directories again.
+     */
+    void rescan();
+
+    /**
+     * @brief Add an archive of assets.
+     *
+     * The archives are searched before the search directories, in the order
+     * they were added.
+     *
+     * @param path the path of the archive
+     * @returns true if the archive could be opened
+     */
+    bool addArchive(const boost::filesystem::path& path);
+
+    /**
+     * @brief Find a file in the search directories.
+     *
+     * @param relative_path the path of the file, relative to a search
+     * directory (or absolute)
+     * @returns the absolute path of the file, or an empty path if it is in
+     * no search directory
+     */
     boost::filesystem::path getAbsolutePath(const boost::filesystem::path& relative_path);
 
+    /**
+     * @brief Find an asset in the archives.
+     *
+     * @param relative_path the path of the asset
+     * @param size the size of the data of the asset
+     * @returns the data of the asset, or @c nullptr if it is in no archive
+     */
+    const char *findArchivedAsset(const boost::filesystem::path& relative_path, std::size_t& size) const;
+
+  private:
+    void scan(const boost::filesystem::path& searchdir);
+
   private:
     std::vector<boost::filesystem::path> m_searchdirs;
+    // the relative path (with '/' as a separator) of each indexed file
+    std::unordered_map<std::string, boost::filesystem::path> m_index;
+    // the relative paths that were not found, reported only once
+    std::unordered_set<std::string> m_missing;
+    std::vector<std::unique_ptr<AssetArchive>> m_archives;
   };
 
 }
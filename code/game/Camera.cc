@@ -51,6 +51,12 @@ namespace game {
     m_view.setCenter(center);
   }
 
+  sf::FloatRect SceneCamera::getVisibleRect() const {
+    const sf::Vector2f& center = m_view.getCenter();
+    const sf::Vector2f& size = m_view.getSize();
+    return sf::FloatRect(center.x - size.x / 2, center.y - size.y / 2, size.x, size.y);
+  }
+
 
   FixedRatioCamera::FixedRatioCamera(sf::RenderWindow& window, float width, float height, const sf::Vector2f& center)
   : SceneCamera(center)
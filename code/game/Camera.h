@@ -57,6 +57,13 @@ namespace game {
     const sf::Vector2f& getCenter() const;
     void setCenter(const sf::Vector2f& center);
 
+    /**
+     * @brief Get the rectangle of the world that is visible.
+     *
+     * @returns the visible rectangle, in world coordinates
+     */
+    sf::FloatRect getVisibleRect() const;
+
   protected:
     sf::View m_view;
   };
@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2014-2015, Julien Bernard
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#ifndef GAME_DELEGATE_H
+#define GAME_DELEGATE_H
+
+#include <cassert>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace game {
+
+  template<typename Signature>
+  class Delegate;
+
+  /**
+   * @brief A callable object stored inline.
+   *
+   * This is a lightweight alternative to std::function. The callable is
+   * stored in a fixed buffer inside the delegate, so a delegate never
+   * allocates. The callable must fit in the buffer and must be trivially
+   * copyable and destructible (e.g. a lambda that captures pointers or
+   * references), so that a delegate can be copied and moved like a plain
+   * struct. A call is a single indirect call to a function that knows the
+   * type of the callable.
+   *
+   * @ingroup base
+   */
+  template<typename R, typename ... Args>
+  class Delegate<R(Args...)> {
+  public:
+    /**
+     * @brief The size of the buffer.
+     *
+     * It is large enough for a pointer to a member function and an object.
+     */
+    static constexpr std::size_t BUFFER_SIZE = 4 * sizeof(void *);
+
+    /**
+     * @brief Create an empty delegate.
+     */
+    Delegate()
+    : m_call(nullptr)
+    {
+    }
+
+    /**
+     * @brief Create an empty delegate.
+     */
+    Delegate(std::nullptr_t)
+    : m_call(nullptr)
+    {
+    }
+
+    /**
+     * @brief Create a delegate from a callable.
+     *
+     * @param func the callable
+     */
+    template<typename F, typename = typename std::enable_if<!std::is_same<typename std::decay<F>::type, Delegate>::value>::type>
+    Delegate(F func) {
+      static_assert(sizeof(F) <= BUFFER_SIZE, "The callable is too large for a delegate");
+      static_assert(alignof(F) <= alignof(Storage), "The callable is too aligned for a delegate");
+      static_assert(std::is_trivially_copyable<F>::value, "The callable must be trivially copyable");
+      static_assert(std::is_trivially_destructible<F>::value, "The callable must be trivially destructible");
+
+      new (&m_storage) F(func);
+      m_call = &invoke<F>;
+    }
+
+    /**
+     * @brief Create a delegate from a member function.
+     *
+     * @param pm the member function
+     * @param obj the object
+     * @returns the delegate
+     */
+    template<typename T, typename M>
+    static Delegate fromMember(M T::*pm, T *obj) {
+      assert(obj != nullptr);
+      return Delegate([pm, obj](Args... args) -> R {
+        return (obj->*pm)(std::forward<Args>(args)...);
+      });
+    }
+
+    explicit operator bool() const {
+      return m_call != nullptr;
+    }
+
+    R operator()(Args... args) const {
+      assert(m_call != nullptr);
+      return m_call(&m_storage, std::forward<Args>(args)...);
+    }
+
+  private:
+    typedef typename std::aligned_storage<BUFFER_SIZE, alignof(void *)>::type Storage;
+    typedef R (*Call)(void *, Args...);
+
+    template<typename F>
+    static R invoke(void *storage, Args... args) {
+      return (*static_cast<F *>(storage))(std::forward<Args>(args)...);
+    }
+
+  private:
+    mutable Storage m_storage;
+    Call m_call;
+  };
+
+}
+
+#endif // GAME_DELEGATE_H
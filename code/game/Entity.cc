@@ -30,8 +30,22 @@ namespace game {
     // default: do nothing
   }
 
+  void Entity::interpolate(float alpha) {
+    // default: do nothing
+  }
+
   void Entity::render(sf::RenderWindow& window) {
     // default: do nothing
   }
 
+  bool Entity::getBounds(sf::FloatRect& bounds) const {
+    // default: no bounds
+    return false;
+  }
+
+  void Entity::renderBatched(SpriteBatch& batch) {
+    batch.flush();
+    render(batch.getWindow());
+  }
+
 }
@@ -24,6 +24,8 @@
 
 #include <SFML/Graphics.hpp>
 
+#include "SpriteBatch.h"
+
 namespace game {
 
   /**
@@ -34,6 +36,7 @@ namespace game {
     Entity(int priority = 0)
     : m_priority(priority)
     , m_alive(true)
+    , m_concurrent(false)
     {
     }
 
@@ -51,12 +54,72 @@ namespace game {
       m_alive = false;
     }
 
+    bool isConcurrent() const {
+      return m_concurrent;
+    }
+
+    /**
+     * @brief Allow the entity to be updated concurrently.
+     *
+     * A concurrent entity may be updated in a worker thread, at the same time
+     * as the other concurrent entities of the same priority. Its update()
+     * must not modify any shared state, including the EntityManager.
+     *
+     * @param concurrent true if the entity is concurrent
+     * @sa EntityManager::setJobSystem()
+     */
+    void setConcurrent(bool concurrent = true) {
+      m_concurrent = concurrent;
+    }
+
     virtual void update(float dt);
+
+    /**
+     * @brief Prepare the rendering between the two last updates.
+     *
+     * This function is called before the entity is rendered. An entity that
+     * moves can compute its rendered position at @c previous + @c alpha *
+     * (@c current - @c previous), so that the motion is smooth even if the
+     * updates are not in sync with the frames. The default implementation
+     * does nothing.
+     *
+     * @param alpha the interpolation factor, in [0, 1]
+     * @sa GameLoop::getAlpha()
+     */
+    virtual void interpolate(float alpha);
+
     virtual void render(sf::RenderWindow& window);
 
+    /**
+     * @brief Get the bounds of the entity.
+     *
+     * The bounds are used to skip the entities that are out of the visible
+     * rectangle. The default implementation has no bounds, so the entity is
+     * always rendered.
+     *
+     * @param bounds the bounds of the entity, in world coordinates
+     * @returns true if the entity has bounds
+     * @sa EntityManager::render(sf::RenderWindow&, const sf::FloatRect&)
+     */
+    virtual bool getBounds(sf::FloatRect& bounds) const;
+
+    /**
+     * @brief Render the entity in a sprite batch.
+     *
+     * The default implementation flushes the batch and calls
+     * render(sf::RenderWindow&), so that the draw order is kept. Entities
+     * made of sprites should override this function and add their sprites to
+     * the batch.
+     *
+     * @param batch the batch
+     * @sa EntityManager::render(SpriteBatch&)
+     */
+    virtual void renderBatched(SpriteBatch& batch);
+
   private:
     const int m_priority;
     bool m_alive;
+    bool m_concurrent;
   };
 
 }
@@ -27,41 +27,292 @@
 
 namespace game {
 
-  void EntityManager::update(float dt) {
-    // erase-remove idiom
-    m_entities.erase(std::remove_if(m_entities.begin(), m_entities.end(), [](const Entity *e) {
-      return !e->isAlive();
-    }), m_entities.end());
+  namespace {
+
+    struct PriorityCompare {
+      template<typename Item>
+      bool operator()(const Item& item, int priority) const {
+        return item.priority < priority;
+      }
+
+      template<typename Item>
+      bool operator()(int priority, const Item& item) const {
+        return priority < item.priority;
+      }
 
-    std::sort(m_entities.begin(), m_entities.end(), [](const Entity * e1, const Entity * e2) {
-      return e1->getPriority() < e2->getPriority();
-    });
+      template<typename Item>
+      bool operator()(const Item& item1, const Item& item2) const {
+        return item1.priority < item2.priority;
+      }
+    };
 
-    for (auto entity : m_entities) {
-      entity->update(dt);
+    bool isVisible(const Entity *e, const sf::FloatRect *visible) {
+      if (e == nullptr) {
+        return false;
+      }
+
+      if (visible == nullptr) {
+        return true;
+      }
+
+      sf::FloatRect bounds;
+      return !e->getBounds(bounds) || visible->intersects(bounds);
     }
+
   }
 
-  void EntityManager::render(sf::RenderWindow& window) {
-    for (auto entity : m_entities) {
-      entity->render(window);
+  EntityManager::EntityManager()
+  : m_jobs(nullptr)
+  {
+  }
+
+  void EntityManager::update(float dt) {
+    flush();
+
+    if (m_jobs != nullptr) {
+      updateInParallel(dt);
+      return;
+    }
+
+    for (auto& item : m_entities) {
+      if (item.entity != nullptr) {
+        item.entity->update(dt);
+      }
     }
   }
 
-  void EntityManager::addEntity(Entity& e) {
-    m_entities.push_back(&e);
+  void EntityManager::render(sf::RenderWindow& window, float alpha) {
+    interpolate(alpha);
+    renderVisible(window, nullptr);
+  }
+
+  void EntityManager::render(SpriteBatch& batch, float alpha) {
+    interpolate(alpha);
+    renderVisible(batch, nullptr);
+  }
+
+  void EntityManager::render(sf::RenderWindow& window, const sf::FloatRect& visible, float alpha) {
+    interpolate(alpha);
+    renderVisible(window, &visible);
+  }
+
+  void EntityManager::render(SpriteBatch& batch, const sf::FloatRect& visible, float alpha) {
+    interpolate(alpha);
+    renderVisible(batch, &visible);
+  }
+
+  EntityHandle EntityManager::addEntity(Entity& e) {
+    uint32_t index = allocateSlot(e);
+
+    // keep the entities sorted by priority, after the entities of same priority
+    auto it = std::upper_bound(m_entities.begin(), m_entities.end(), e.getPriority(), PriorityCompare());
+    std::size_t position = it - m_entities.begin();
+    m_entities.insert(it, { &e, index, e.getPriority() });
+    updatePositions(position);
+
+    return EntityHandle(index, m_slots[index].generation);
+  }
+
+  Entity *EntityManager::removeEntity(EntityHandle h) {
+    if (!hasEntity(h)) {
+      return nullptr;
+    }
+
+    Slot& slot = m_slots[h.index];
+    Entity *e = slot.entity;
+
+    if (slot.position != NO_POSITION) {
+      // the item is erased at the next flush
+      m_entities[slot.position].entity = nullptr;
+    }
+
+    releaseSlot(h.index);
+    return e;
   }
 
   Entity *EntityManager::removeEntity(Entity *e) {
-    // erase-remove idiom
-    auto it = std::remove(m_entities.begin(), m_entities.end(), e);
+    auto it = m_lookup.find(e);
+
+    if (it == m_lookup.end()) {
+      return nullptr;
+    }
+
+    uint32_t index = it->second;
+    return removeEntity(EntityHandle(index, m_slots[index].generation));
+  }
+
+  Entity *EntityManager::getEntity(EntityHandle h) const {
+    if (!hasEntity(h)) {
+      return nullptr;
+    }
+
+    return m_slots[h.index].entity;
+  }
+
+  bool EntityManager::hasEntity(EntityHandle h) const {
+    return h.index < m_slots.size() && m_slots[h.index].generation == h.generation && m_slots[h.index].entity != nullptr;
+  }
+
+  EntityHandle EntityManager::deferAddEntity(Entity& e) {
+    uint32_t index = allocateSlot(e);
+    EntityHandle h(index, m_slots[index].generation);
+    m_added.push_back(h);
+    return h;
+  }
+
+  void EntityManager::flush() {
+    // compact the storage, in order
+    std::size_t size = 0;
+
+    for (auto& item : m_entities) {
+      if (item.entity == nullptr) {
+        continue;
+      }
+
+      if (!item.entity->isAlive()) {
+        releaseSlot(item.slot);
+        continue;
+      }
 
-    if (it != m_entities.end()) {
-      m_entities.erase(it, m_entities.end());
-      return e;
+      m_slots[item.slot].position = size;
+      m_entities[size++] = item;
     }
 
-    return nullptr;
+    m_entities.resize(size);
+
+    if (m_added.empty()) {
+      return;
+    }
+
+    for (auto h : m_added) {
+      // the entity may have been removed in the meantime
+      if (hasEntity(h)) {
+        Entity *e = m_slots[h.index].entity;
+        m_entities.push_back({ e, h.index, e->getPriority() });
+      }
+    }
+
+    m_added.clear();
+
+    auto middle = m_entities.begin() + size;
+
+    if (middle == m_entities.end()) {
+      return;
+    }
+
+    std::stable_sort(middle, m_entities.end(), PriorityCompare());
+
+    // the existing entities come first for the same priority
+    auto first = std::upper_bound(m_entities.begin(), middle, middle->priority, PriorityCompare());
+    std::inplace_merge(first, middle, m_entities.end(), PriorityCompare());
+    updatePositions(first - m_entities.begin());
+  }
+
+  uint32_t EntityManager::allocateSlot(Entity& e) {
+    assert(m_lookup.find(&e) == m_lookup.end());
+    uint32_t index;
+
+    if (m_free.empty()) {
+      index = m_slots.size();
+      m_slots.push_back({ nullptr, 1, NO_POSITION });
+    } else {
+      index = m_free.back();
+      m_free.pop_back();
+    }
+
+    Slot& slot = m_slots[index];
+    slot.entity = &e;
+    slot.position = NO_POSITION;
+    m_lookup.emplace(&e, index);
+    return index;
+  }
+
+  void EntityManager::releaseSlot(uint32_t index) {
+    Slot& slot = m_slots[index];
+    m_lookup.erase(slot.entity);
+    slot.entity = nullptr;
+    slot.position = NO_POSITION;
+
+    // the generation 0 is never valid
+    if (++slot.generation == 0) {
+      slot.generation = 1;
+    }
+
+    m_free.push_back(index);
+  }
+
+  void EntityManager::updateInParallel(float dt) {
+    // below this size, it is not worth waking the workers up
+    static constexpr std::size_t PARALLEL_THRESHOLD = 32;
+
+    auto it = m_entities.begin();
+
+    while (it != m_entities.end()) {
+      // the entities of the same priority
+      auto last = std::upper_bound(it, m_entities.end(), it->priority, PriorityCompare());
+
+      // the other entities first, as they may remove concurrent entities
+      for (auto item = it; item != last; ++item) {
+        if (item->entity != nullptr && !item->entity->isConcurrent()) {
+          item->entity->update(dt);
+        }
+      }
+
+      m_concurrent.clear();
+
+      for (; it != last; ++it) {
+        if (it->entity != nullptr && it->entity->isConcurrent()) {
+          m_concurrent.push_back(it->entity);
+        }
+      }
+
+      if (m_concurrent.size() < PARALLEL_THRESHOLD) {
+        for (auto entity : m_concurrent) {
+          entity->update(dt);
+        }
+      } else {
+        m_jobs->parallelFor(m_concurrent.size(), [this, dt](std::size_t i) {
+          m_concurrent[i]->update(dt);
+        });
+      }
+    }
+  }
+
+  void EntityManager::interpolate(float alpha) {
+    // before the culling, as the bounds may depend on the rendered position
+    for (auto& item : m_entities) {
+      if (item.entity != nullptr) {
+        item.entity->interpolate(alpha);
+      }
+    }
+  }
+
+  void EntityManager::renderVisible(sf::RenderWindow& window, const sf::FloatRect *visible) {
+    for (auto& item : m_entities) {
+      if (isVisible(item.entity, visible)) {
+        item.entity->render(window);
+      }
+    }
+  }
+
+  void EntityManager::renderVisible(SpriteBatch& batch, const sf::FloatRect *visible) {
+    for (std::size_t i = 0; i < m_entities.size(); ++i) {
+      const Item& item = m_entities[i];
+
+      if (isVisible(item.entity, visible)) {
+        item.entity->renderBatched(batch);
+      }
+
+      if (i + 1 == m_entities.size() || m_entities[i + 1].priority != item.priority) {
+        batch.flush();
+      }
+    }
+  }
+
+  void EntityManager::updatePositions(std::size_t first) {
+    for (std::size_t i = first; i < m_entities.size(); ++i) {
+      m_slots[m_entities[i].slot].position = i;
+    }
   }
 
 }
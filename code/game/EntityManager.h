@@ -22,24 +22,128 @@
 #ifndef GAME_ENTITY_MANAGER_H
 #define GAME_ENTITY_MANAGER_H
 
+#include <unordered_map>
 #include <vector>
 
 #include <SFML/Graphics.hpp>
 
 #include "Entity.h"
+#include "Handle.h"
+#include "SpriteBatch.h"
+#include "JobSystem.h"
 
 namespace game {
 
   /**
    * @ingroup graphics
    */
+  typedef Handle<Entity> EntityHandle;
+
+  /**
+   * @brief A set of entities, updated and rendered by priority.
+   *
+   * The entities are referenced by generational handles. The lookup, the
+   * removal and the liveness check of a handle are done in constant time.
+   * The entities are stored contiguously, sorted by priority.
+   *
+   * @ingroup graphics
+   */
   class EntityManager {
   public:
+    EntityManager();
+
+    /**
+     * @brief Set a job system for the update of concurrent entities.
+     *
+     * When a job system is set, the concurrent entities of the same priority
+     * are updated in parallel. The priorities are still updated in order: all
+     * the entities of a priority are updated before the entities of the next
+     * priority. The other entities are updated on the calling thread, before
+     * the concurrent entities of their priority, so they can remove them.
+     *
+     * @param jobs the job system or @c nullptr to update sequentially
+     * @sa Entity::setConcurrent()
+     */
+    void setJobSystem(JobSystem *jobs) {
+      m_jobs = jobs;
+    }
 
     void update(float dt);
-    void render(sf::RenderWindow& window);
 
-    void addEntity(Entity& e);
+    /**
+     * @brief Render the entities.
+     *
+     * @param window the window
+     * @param alpha the interpolation factor between the two last updates
+     * @sa Entity::interpolate(), GameLoop::update()
+     */
+    void render(sf::RenderWindow& window, float alpha = 1.0f);
+
+    /**
+     * @brief Render the entities in a sprite batch.
+     *
+     * The batch is flushed after each priority, so an entity is always drawn
+     * above the entities of lower priorities.
+     *
+     * @param batch the batch
+     * @param alpha the interpolation factor between the two last updates
+     * @sa Entity::renderBatched()
+     */
+    void render(SpriteBatch& batch, float alpha = 1.0f);
+
+    /**
+     * @brief Render the entities that are visible.
+     *
+     * An entity is skipped if it has bounds that do not intersect the
+     * visible rectangle.
+     *
+     * @param window the window
+     * @param visible the visible rectangle, in world coordinates
+     * @param alpha the interpolation factor between the two last updates
+     * @sa Entity::getBounds(), SceneCamera::getVisibleRect()
+     */
+    void render(sf::RenderWindow& window, const sf::FloatRect& visible, float alpha = 1.0f);
+
+    /**
+     * @brief Render the entities that are visible in a sprite batch.
+     *
+     * @param batch the batch
+     * @param visible the visible rectangle, in world coordinates
+     * @param alpha the interpolation factor between the two last updates
+     * @sa render(SpriteBatch&, float), render(sf::RenderWindow&, const sf::FloatRect&, float)
+     */
+    void render(SpriteBatch& batch, const sf::FloatRect& visible, float alpha = 1.0f);
+
+    /**
+     * @brief Add an entity immediately.
+     *
+     * This function must not be called during update().
+     *
+     * @param e the entity to add
+     * @returns a handle to the entity
+     * @sa deferAddEntity()
+     */
+    EntityHandle addEntity(Entity& e);
+
+    /**
+     * @brief Remove an entity.
+     *
+     * The entity is not updated nor rendered anymore. Its storage is
+     * reclaimed at the next flush. This function can be called safely during
+     * update().
+     *
+     * @param h the handle of the entity to remove
+     * @returns the removed entity or @c nullptr if the handle is stale
+     */
+    Entity *removeEntity(EntityHandle h);
+
+    /**
+     * @brief Remove an entity.
+     *
+     * @param e the entity to remove
+     * @returns the removed entity or @c nullptr if it was not found
+     * @sa removeEntity(EntityHandle)
+     */
     Entity *removeEntity(Entity *e);
 
     template<typename E>
@@ -48,8 +152,101 @@ namespace game {
       return static_cast<E*>(removeEntity(e));
     }
 
+    template<typename E>
+    E *removeTypedEntity(EntityHandle h) {
+      static_assert(std::is_base_of<Entity, E>::value, "E must be an Entity");
+      return static_cast<E*>(removeEntity(h));
+    }
+
+    /**
+     * @brief Get an entity from its handle.
+     *
+     * @param h the handle of the entity
+     * @returns the entity or @c nullptr if the handle is stale
+     */
+    Entity *getEntity(EntityHandle h) const;
+
+    template<typename E>
+    E *getTypedEntity(EntityHandle h) const {
+      static_assert(std::is_base_of<Entity, E>::value, "E must be an Entity");
+      return static_cast<E*>(getEntity(h));
+    }
+
+    /**
+     * @brief Tell whether a handle references an entity of the manager.
+     *
+     * @param h the handle of the entity
+     * @returns true if the handle is not stale
+     */
+    bool hasEntity(EntityHandle h) const;
+
+    /**
+     * @brief Add an entity at the next flush.
+     *
+     * This function can be called safely during update(). The handle is
+     * valid immediately but the entity is only updated and rendered after
+     * the next flush.
+     *
+     * @param e the entity to add
+     * @returns a handle to the entity
+     * @sa flush()
+     */
+    EntityHandle deferAddEntity(Entity& e);
+
+    /**
+     * @brief Remove an entity at the next flush.
+     *
+     * This is the same as removeEntity() as the removals are always applied
+     * at the next flush.
+     *
+     * @param e the entity to remove
+     * @sa flush()
+     */
+    void deferRemoveEntity(Entity *e) {
+      removeEntity(e);
+    }
+
+    /**
+     * @brief Apply the deferred additions and removals.
+     *
+     * The dead entities are removed in the same pass. This function is
+     * called at the beginning of update().
+     */
+    void flush();
+
+  private:
+    static constexpr uint32_t NO_POSITION = UINT32_MAX;
+
+    struct Slot {
+      Entity *entity;
+      uint32_t generation;
+      uint32_t position; // in m_entities
+    };
+
+    struct Item {
+      Entity *entity; // nullptr when removed
+      uint32_t slot;
+      int priority;
+    };
+
+    uint32_t allocateSlot(Entity& e);
+    void releaseSlot(uint32_t index);
+    void updatePositions(std::size_t first);
+    void updateInParallel(float dt);
+    void interpolate(float alpha);
+    void renderVisible(sf::RenderWindow& window, const sf::FloatRect *visible);
+    void renderVisible(SpriteBatch& batch, const sf::FloatRect *visible);
+
   private:
-    std::vector<Entity *> m_entities;
+    JobSystem *m_jobs;
+    std::vector<Entity *> m_concurrent;
+
+    std::vector<Slot> m_slots;
+    std::vector<uint32_t> m_free;
+    // sorted by priority, in insertion order for the same priority
+    std::vector<Item> m_entities;
+    std::vector<EntityHandle> m_added;
+    std::unordered_map<const Entity *, uint32_t> m_lookup;
   };
 
 
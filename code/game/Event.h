@@ -22,9 +22,9 @@
 #ifndef GAME_EVENT_H
 #define GAME_EVENT_H
 
-#include <functional>
 #include <string>
 
+#include "Delegate.h"
 #include "Id.h"
 
 namespace game {
@@ -51,9 +51,13 @@ namespace game {
   };
 
   /**
+   * @brief A handler of events.
+   *
+   * The handler is stored inline, see Delegate.
+   *
    * @ingroup base
    */
-  typedef std::function<EventStatus(EventType, Event *)> EventHandler;
+  typedef Delegate<EventStatus(EventType, Event *)> EventHandler;
 
 }
 
@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2014-2015, Julien Bernard
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#ifndef GAME_EVENT_CHANNEL_H
+#define GAME_EVENT_CHANNEL_H
+
+#include <cassert>
+#include <cstdint>
+
+#include "Event.h"
+#include "HandlerTable.h"
+
+namespace game {
+
+  /**
+   * @brief The id of a handler of a typed channel.
+   *
+   * Each channel numbers its handlers on its own, so the id has a distinct
+   * type for each event type. It can not be given to the channel of another
+   * type, nor to EventManager::removeHandler().
+   *
+   * @ingroup base
+   */
+  template<typename E>
+  struct TypedEventHandlerId {
+    TypedEventHandlerId()
+    : value(0)
+    {
+    }
+
+    explicit TypedEventHandlerId(uint64_t value)
+    : value(value)
+    {
+    }
+
+    uint64_t value;
+  };
+
+  template<typename E>
+  inline
+  bool operator==(const TypedEventHandlerId<E>& lhs, const TypedEventHandlerId<E>& rhs) {
+    return lhs.value == rhs.value;
+  }
+
+  template<typename E>
+  inline
+  bool operator!=(const TypedEventHandlerId<E>& lhs, const TypedEventHandlerId<E>& rhs) {
+    return lhs.value != rhs.value;
+  }
+
+  /**
+   * @brief The base of the typed channels.
+   *
+   * @ingroup base
+   */
+  class EventChannelBase {
+  public:
+    virtual ~EventChannelBase() {
+    }
+
+    /**
+     * @brief Trigger an event whose static type is not known.
+     *
+     * @param event the event, of the type of the channel
+     */
+    virtual void triggerUntypedEvent(Event *event) = 0;
+  };
+
+  /**
+   * @brief A channel of events of a single type.
+   *
+   * The handlers of a channel receive the event directly, without a
+   * downcast. They are stored inline (see Delegate) in a contiguous vector,
+   * and the call to a handler is not type-erased beyond the delegate, so a
+   * trigger is a simple loop.
+   *
+   * Like in EventManager, a handler can be registered or removed while an
+   * event is triggered.
+   *
+   * @sa EventManager::getChannel
+   * @ingroup base
+   */
+  template<typename E>
+  class EventChannel : public EventChannelBase {
+  public:
+    static_assert(std::is_base_of<Event, E>::value, "E must be an Event");
+
+    /**
+     * @brief A handler of the events of the channel.
+     */
+    typedef Delegate<EventStatus(const E&)> Handler;
+
+    /**
+     * @brief The id of a handler of the channel.
+     */
+    typedef TypedEventHandlerId<E> HandlerId;
+
+    EventChannel() = default;
+
+    EventChannel(const EventChannel&) = delete;
+    EventChannel& operator=(const EventChannel&) = delete;
+
+    /**
+     * @brief Register a handler.
+     *
+     * @param handler the handler
+     * @returns the id of the handler
+     */
+    HandlerId registerHandler(Handler handler) {
+      assert(handler);
+      return HandlerId(m_table.add(m_handlers, handler));
+    }
+
+    /**
+     * @brief Register a member function as a handler.
+     *
+     * @param pm the member function
+     * @param obj the object
+     * @returns the id of the handler
+     */
+    template<typename R, typename T>
+    HandlerId registerHandler(R T::*pm, T *obj) {
+      return registerHandler(Handler::fromMember(pm, obj));
+    }
+
+    /**
+     * @brief Remove a handler.
+     *
+     * @param id the id of the handler
+     */
+    void removeHandler(HandlerId id) {
+      m_table.remove(id.value);
+    }
+
+    /**
+     * @brief Trigger an event.
+     *
+     * The handlers registered during the trigger are not called.
+     *
+     * @param event the event
+     */
+    void triggerEvent(const E& event) {
+      m_table.dispatch(m_handlers, [&event](typename HandlerTable<Handler>::Entry& entry) {
+        return entry.handler(event);
+      });
+    }
+
+    virtual void triggerUntypedEvent(Event *event) override {
+      triggerEvent(*static_cast<E *>(event));
+    }
+
+  private:
+    HandlerTable<Handler> m_table;
+    typename HandlerTable<Handler>::List m_handlers;
+  };
+
+}
+
+#endif // GAME_EVENT_CHANNEL_H
@@ -26,50 +26,102 @@
 
 namespace game {
   EventManager::EventManager()
-  : m_current_id(0)
+  : m_order_dirty(false)
+  , m_queued_depth(0)
+  , m_recorder(nullptr)
   {
   }
 
-  EventHandlerId EventManager::registerHandler(EventType type, EventHandler handler) {
+  EventManager::~EventManager() {
+  }
+
+  EventHandlerId EventManager::addHandler(EventType type, EventHandler handler, bool batch) {
     assert(handler);
-    auto it = m_handlers.find(type);
+    HandlerList *& list = m_handlers[type];
 
-    if (it == m_handlers.end()) {
-      bool inserted;
-      std::tie(it, inserted) = m_handlers.insert(std::make_pair(type, std::vector<Handler>()));
-      assert(inserted);
+    if (list == nullptr) {
+      m_lists.emplace_back();
+      list = &m_lists.back();
     }
 
-    EventHandlerId id = m_current_id++;
-    it->second.push_back({ id, handler });
-    return id;
+    return m_table.add(*list, { std::move(handler), batch });
   }
 
   void EventManager::removeHandler(EventHandlerId id) {
-    for (auto& handlers : m_handlers) {
-      auto& vec = handlers.second;
-      vec.erase(std::remove_if(vec.begin(), vec.end(), [id](const Handler& h) {
-        return h.id == id;
-      }), vec.end());
-    }
+    m_table.remove(id);
   }
 
   void EventManager::triggerEvent(EventType type, Event *event) {
-    auto it = m_handlers.find(type);
+    dispatch(type, event, 1, &getEventAt<Event>);
 
-    if (it == m_handlers.end()) {
-      return;
+    // then the typed handlers, like in a queued dispatch
+    EventChannelBase **channel = m_channels.find(type);
+
+    if (channel != nullptr) {
+      (*channel)->triggerUntypedEvent(event);
     }
+  }
 
-    std::vector<Handler> kept;
+  void EventManager::dispatchQueued() {
+    auto post = [this](RemoteEvent& event) {
+      event.post(*this);
+    };
 
-    for (auto& handler : it->second) {
-      if (handler.handler(type, event) == EventStatus::KEEP) {
-        kept.push_back(handler);
+    while (m_remote.consume(post)) {
+      // the event has been posted
+    }
+
+    // the order does not change during a dispatch
+    if (m_order_dirty && m_queued_depth == 0) {
+      m_order.clear();
+
+      for (auto& queue : m_queues) {
+        m_order.push_back(queue.get());
       }
+
+      std::stable_sort(m_order.begin(), m_order.end(), [](const EventQueueBase *lhs, const EventQueueBase *rhs) {
+        return lhs->priority < rhs->priority;
+      });
+
+      m_order_dirty = false;
+    }
+
+    ++m_queued_depth;
+
+    // the queues created during the dispatch wait for the next one
+    std::size_t count = m_order.size();
+
+    for (std::size_t i = 0; i < count; ++i) {
+      m_order[i]->dispatch(*this);
     }
 
-    std::swap(it->second, kept);
+    --m_queued_depth;
+  }
+
+  void EventManager::dispatch(EventType type, Event *events, std::size_t count, EventAccessor accessor) {
+    HandlerList **list = m_handlers.find(type);
+
+    if (list == nullptr) {
+      return;
+    }
+
+    m_table.dispatch(**list, [type, events, count, accessor](HandlerTable<Handler>::Entry& entry) {
+      if (entry.handler.batch) {
+        EventBatch batch;
+        batch.events = events;
+        batch.count = count;
+        return entry.handler.func(type, &batch);
+      }
+
+      EventStatus status = EventStatus::KEEP;
+
+      // the handler may remove itself in the middle of the events
+      for (std::size_t j = 0; j < count && entry.alive && status == EventStatus::KEEP; ++j) {
+        status = entry.handler.func(type, accessor(events, j));
+      }
+
+      return status;
+    });
   }
 
 }
@@ -22,14 +22,30 @@
 #ifndef GAME_EVENT_MANAGER_H
 #define GAME_EVENT_MANAGER_H
 
-#include <map>
+#include <cassert>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #include "Event.h"
+#include "EventChannel.h"
+#include "EventRecorder.h"
+#include "HandlerTable.h"
+#include "IdMap.h"
+#include "MpscQueue.h"
 
 namespace game {
 
   /**
+   * @brief The id of a registered handler.
+   *
+   * The typed handlers have their own ids, see TypedEventHandlerId.
+   *
+   * @sa HandlerTable
    * @ingroup base
    */
   typedef uint64_t EventHandlerId;
@@ -40,8 +56,14 @@ namespace game {
   class EventManager {
   public:
     EventManager();
+    ~EventManager();
 
-    EventHandlerId registerHandler(EventType type, EventHandler handler);
+    EventManager(const EventManager&) = delete;
+    EventManager& operator=(const EventManager&) = delete;
+
+    EventHandlerId registerHandler(EventType type, EventHandler handler) {
+      return addHandler(type, std::move(handler), false);
+    }
 
     template<typename E>
     EventHandlerId registerHandler(EventHandler handler) {
@@ -52,14 +74,45 @@ namespace game {
 
     template<typename R, typename T>
     EventHandlerId registerHandler(EventType type, R T::*pm, T *obj) {
-      return registerHandler(type, std::bind(pm, obj, std::placeholders::_1, std::placeholders::_2));
+      return registerHandler(type, EventHandler::fromMember(pm, obj));
     }
 
     template<typename E, typename R, typename T>
     EventHandlerId registerHandler(R T::*pm, T *obj) {
       static_assert(std::is_base_of<Event, E>::value, "E must be an Event");
       static_assert(E::type != INVALID_EVENT, "E must define its type");
-      return registerHandler(E::type, std::bind(pm, obj, std::placeholders::_1, std::placeholders::_2));
+      return registerHandler(E::type, EventHandler::fromMember(pm, obj));
+    }
+
+    /**
+     * @brief Register a handler that receives the events in batches.
+     *
+     * The handler is called with the address of the first event and the
+     * number of events, that are contiguous in memory. A queued dispatch
+     * gives all the events of the frame to the handler in one call. A
+     * synchronous trigger gives a batch of one event.
+     *
+     * @param handler the handler, a callable with the signature
+     * `EventStatus(E *, std::size_t)`
+     * @returns the id of the handler
+     */
+    template<typename E, typename F>
+    EventHandlerId registerBatchHandler(F handler) {
+      static_assert(std::is_base_of<Event, E>::value, "E must be an Event");
+      static_assert(E::type != INVALID_EVENT, "E must define its type");
+      return addHandler(E::type, [handler](EventType type, Event *event) {
+        assert(type == E::type);
+        auto batch = static_cast<EventBatch *>(event);
+        return handler(static_cast<E *>(batch->events), batch->count);
+      }, true);
+    }
+
+    template<typename E, typename R, typename T>
+    EventHandlerId registerBatchHandler(R T::*pm, T *obj) {
+      assert(obj != nullptr);
+      return registerBatchHandler<E>([pm, obj](E *events, std::size_t count) {
+        return (obj->*pm)(events, count);
+      });
     }
 
     void removeHandler(EventHandlerId id);
@@ -76,17 +129,366 @@ namespace game {
     void triggerEvent(E *event) {
       static_assert(std::is_base_of<Event, E>::value, "E must be an Event");
       static_assert(E::type != INVALID_EVENT, "E must define its type");
+
+      if (m_recorder != nullptr) {
+        recordEvent(*event, std::is_trivially_copyable<E>());
+      }
+
       triggerEvent(E::type, event);
     }
 
+    /**
+     * @brief Set a recorder for the triggered and posted events.
+     *
+     * The events triggered with a static type and the posted events (from
+     * any thread) that are trivially copyable are recorded, the others are
+     * ignored. The posted events are recorded when they are posted in their
+     * queue, before any coalescing, so that a replay with
+     * EventReplayer::replayQueuedTo() goes through the same path.
+     *
+     * @param recorder the recorder, or @c nullptr to stop recording
+     */
+    void setRecorder(EventRecorder *recorder) {
+      m_recorder = recorder;
+    }
+
+    /**
+     * @brief Get the typed channel of an event type.
+     *
+     * The channel is created if needed. It does not move afterwards, so a
+     * reference can be kept to trigger the events without a lookup.
+     *
+     * @returns the channel
+     */
+    template<typename E>
+    EventChannel<E>& getChannel() {
+      static_assert(E::type != INVALID_EVENT, "E must define its type");
+      EventChannelBase *& channel = m_channels[E::type];
+
+      if (channel == nullptr) {
+        m_channel_storage.emplace_back(new EventChannel<E>);
+        channel = m_channel_storage.back().get();
+      }
+
+      return *static_cast<EventChannel<E> *>(channel);
+    }
+
+    /**
+     * @brief Register a typed handler.
+     *
+     * The handler receives the event as a `const E&`. It is called for every
+     * delivery of the event: by triggerEvent(), triggerTypedEvent() and
+     * dispatchQueued(). triggerTypedEvent() calls only the typed handlers,
+     * without any lookup of the untyped handlers.
+     *
+     * @param handler the handler, a callable with the signature
+     * `EventStatus(const E&)`
+     * @returns the id of the handler
+     */
+    template<typename E, typename F>
+    TypedEventHandlerId<E> registerTypedHandler(F handler) {
+      return getChannel<E>().registerHandler(handler);
+    }
+
+    template<typename E, typename R, typename T>
+    TypedEventHandlerId<E> registerTypedHandler(R T::*pm, T *obj) {
+      return getChannel<E>().registerHandler(pm, obj);
+    }
+
+    template<typename E>
+    void removeTypedHandler(TypedEventHandlerId<E> id) {
+      EventChannel<E> *channel = findChannel<E>();
+
+      if (channel != nullptr) {
+        channel->removeHandler(id);
+      }
+    }
+
+    /**
+     * @brief Trigger an event for the typed handlers only.
+     *
+     * @param event the event
+     */
+    template<typename E>
+    void triggerTypedEvent(const E& event) {
+      EventChannel<E> *channel = findChannel<E>();
+
+      if (channel != nullptr) {
+        channel->triggerEvent(event);
+      }
+    }
+
+    /**
+     * @brief Post an event for the next queued dispatch.
+     *
+     * The event is copied (or moved) in the queue of its type, so the
+     * events of a type are contiguous in memory. Nothing is called until
+     * dispatchQueued().
+     *
+     * @param event the event
+     */
+    template<typename E>
+    void postEvent(E&& event) {
+      typedef typename std::decay<E>::type Type;
+      static_assert(std::is_base_of<Event, Type>::value, "E must be an Event");
+      static_assert(Type::type != INVALID_EVENT, "E must define its type");
+
+      if (m_recorder != nullptr) {
+        recordEvent(static_cast<const Type&>(event), std::is_trivially_copyable<Type>());
+      }
+
+      getQueue<Type>().post(std::forward<E>(event));
+    }
+
+    /**
+     * @brief Coalesce the posted events of a type, the latest wins.
+     *
+     * At most one event of the type is delivered by a queued dispatch: a
+     * posted event replaces the event already waiting.
+     */
+    template<typename E>
+    void coalesceEvents() {
+      getQueue<E>().merge = [](E& current, const E& event) {
+        current = event;
+      };
+    }
+
+    /**
+     * @brief Coalesce the posted events of a type with a merge function.
+     *
+     * At most one event of the type is delivered by a queued dispatch: a
+     * posted event is merged in the event already waiting.
+     *
+     * @param merge the merge function, a callable with the signature
+     * `void(E& current, const E& event)`
+     */
+    template<typename E, typename F>
+    void coalesceEvents(F merge) {
+      getQueue<E>().merge = merge;
+    }
+
+    /**
+     * @brief Set the priority of the queued events of a type.
+     *
+     * The queued events are dispatched by priority, the lowest first. The
+     * types of the same priority are dispatched in the order of their first
+     * post (or configuration). The default priority is 0.
+     *
+     * @param priority the priority
+     */
+    template<typename E>
+    void setEventPriority(int priority) {
+      getQueue<E>().priority = priority;
+      m_order_dirty = true;
+    }
+
+    /**
+     * @brief Post an event from any thread.
+     *
+     * The event is copied in a lock-free queue, so the thread never waits
+     * for the main thread. The queue is drained at the beginning of the
+     * next dispatchQueued(), where the event is posted like with
+     * postEvent().
+     *
+     * The event is stored inline in the node of the queue, so a post makes
+     * a single allocation. The event must fit in RemoteEvent::BUFFER_SIZE.
+     *
+     * @param event the event
+     */
+    template<typename E>
+    void postFromAnyThread(E&& event) {
+      typedef typename std::decay<E>::type Type;
+      static_assert(std::is_base_of<Event, Type>::value, "E must be an Event");
+      static_assert(Type::type != INVALID_EVENT, "E must define its type");
+
+      m_remote.emplace(std::forward<E>(event));
+    }
+
+    /**
+     * @brief Dispatch the posted events.
+     *
+     * This function must be called from the thread that owns the manager.
+     * The events posted from other threads are posted first. Then, the
+     * events of a type are delivered together: a batch handler is called
+     * once with all of them, another handler (typed or not) is called for
+     * each of them. The events posted during the dispatch are kept for the
+     * next dispatch.
+     */
+    void dispatchQueued();
+
   private:
     struct Handler {
-      EventHandlerId id;
-      EventHandler handler;
+      EventHandler func;
+      bool batch; // the handler expects an EventBatch
+    };
+
+    typedef HandlerTable<Handler>::List HandlerList;
+
+    // an event posted from another thread, with the function that posts it
+    class RemoteEvent {
+    public:
+      static constexpr std::size_t BUFFER_SIZE = 8 * sizeof(void *);
+
+      template<typename E>
+      explicit RemoteEvent(E&& event) {
+        typedef typename std::decay<E>::type Type;
+        static_assert(sizeof(Type) <= BUFFER_SIZE, "The event is too large to be posted from another thread");
+        static_assert(alignof(Type) <= alignof(Storage), "The event is too aligned to be posted from another thread");
+
+        new (&m_storage) Type(std::forward<E>(event));
+        m_post = &postAndDestroy<Type>;
+      }
+
+      ~RemoteEvent() {
+        if (m_post != nullptr) {
+          m_post(nullptr, &m_storage);
+        }
+      }
+
+      RemoteEvent(const RemoteEvent&) = delete;
+      RemoteEvent& operator=(const RemoteEvent&) = delete;
+
+      void post(EventManager& manager) {
+        m_post(&manager, &m_storage);
+        m_post = nullptr;
+      }
+
+    private:
+      typedef std::aligned_storage<BUFFER_SIZE, alignof(std::max_align_t)>::type Storage;
+      // post the event if there is a manager, then destroy it
+      typedef void (*Post)(EventManager *, void *);
+
+      template<typename E>
+      static void postAndDestroy(EventManager *manager, void *storage) {
+        E *event = static_cast<E *>(storage);
+
+        if (manager != nullptr) {
+          manager->postEvent(std::move(*event));
+        }
+
+        event->~E();
+      }
+
+    private:
+      Storage m_storage;
+      Post m_post;
     };
 
-    EventHandlerId m_current_id;
-    std::map<EventType, std::vector<Handler>> m_handlers;
+    // the events given to a batch handler
+    struct EventBatch : public Event {
+      Event *events;
+      std::size_t count;
+    };
+
+    typedef Event *(*EventAccessor)(Event *, std::size_t);
+
+    template<typename E>
+    static Event *getEventAt(Event *events, std::size_t index) {
+      return static_cast<E *>(events) + index;
+    }
+
+    struct EventQueueBase {
+      EventQueueBase()
+      : priority(0)
+      {
+      }
+
+      virtual ~EventQueueBase() {
+      }
+
+      virtual void dispatch(EventManager& manager) = 0;
+
+      int priority;
+    };
+
+    template<typename E>
+    struct EventQueue : public EventQueueBase {
+      // the buffers are swapped before a dispatch and keep their capacity
+      std::vector<E> posted;
+      std::vector<E> dispatched;
+      // empty when the events are not coalesced
+      Delegate<void(E&, const E&)> merge;
+
+      template<typename T>
+      void post(T&& event) {
+        if (merge && !posted.empty()) {
+          merge(posted.back(), event);
+        } else {
+          posted.push_back(std::forward<T>(event));
+        }
+      }
+
+      virtual void dispatch(EventManager& manager) override {
+        // a nested dispatch leaves the type being dispatched to the outer one
+        if (posted.empty() || !dispatched.empty()) {
+          return;
+        }
+
+        std::swap(posted, dispatched);
+        manager.dispatch(E::type, dispatched.data(), dispatched.size(), &getEventAt<E>);
+
+        EventChannel<E> *channel = manager.findChannel<E>();
+
+        if (channel != nullptr) {
+          for (auto& event : dispatched) {
+            channel->triggerEvent(event);
+          }
+        }
+
+        dispatched.clear();
+      }
+    };
+
+    template<typename E>
+    void recordEvent(const E& event, std::true_type) {
+      m_recorder->recordEvent(event);
+    }
+
+    template<typename E>
+    void recordEvent(const E&, std::false_type) {
+    }
+
+    template<typename E>
+    EventQueue<E>& getQueue() {
+      static_assert(std::is_base_of<Event, E>::value, "E must be an Event");
+      static_assert(E::type != INVALID_EVENT, "E must define its type");
+      EventQueueBase *& queue = m_queued[E::type];
+
+      if (queue == nullptr) {
+        m_queues.emplace_back(new EventQueue<E>);
+        queue = m_queues.back().get();
+        m_order_dirty = true;
+      }
+
+      return *static_cast<EventQueue<E> *>(queue);
+    }
+
+    template<typename E>
+    EventChannel<E> *findChannel() {
+      EventChannelBase **channel = m_channels.find(E::type);
+      return channel == nullptr ? nullptr : static_cast<EventChannel<E> *>(*channel);
+    }
+
+    EventHandlerId addHandler(EventType type, EventHandler handler, bool batch);
+    void dispatch(EventType type, Event *events, std::size_t count, EventAccessor accessor);
+
+    HandlerTable<Handler> m_table;
+    // a deque, so that a list does not move when another is added
+    std::deque<HandlerList> m_lists;
+    IdMap<HandlerList *> m_handlers;
+    // the queues, in the order of their first post
+    std::vector<std::unique_ptr<EventQueueBase>> m_queues;
+    IdMap<EventQueueBase *> m_queued;
+    // the queues sorted by priority
+    std::vector<EventQueueBase *> m_order;
+    bool m_order_dirty;
+    // the number of queued dispatches in progress
+    unsigned m_queued_depth;
+    std::vector<std::unique_ptr<EventChannelBase>> m_channel_storage;
+    IdMap<EventChannelBase *> m_channels;
+    EventRecorder *m_recorder;
+    // the events posted from other threads
+    MpscQueue<RemoteEvent> m_remote;
   };
 
 }
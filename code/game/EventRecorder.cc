@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2014-2015, Julien Bernard
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#include "EventRecorder.h"
+
+#include <cassert>
+
+#include "Log.h"
+
+namespace game {
+
+  constexpr uint32_t EventRecorder::MAGIC;
+  constexpr uint32_t EventRecorder::VERSION;
+
+  EventRecorder::EventRecorder()
+  : m_file(nullptr)
+  {
+  }
+
+  EventRecorder::~EventRecorder() {
+    close();
+  }
+
+  bool EventRecorder::open(const std::string& path) {
+    close();
+
+    m_file = std::fopen(path.c_str(), "wb");
+
+    if (m_file == nullptr) {
+      Log::error(Log::GENERAL, "Could not open the trace: %s\n", path.c_str());
+      return false;
+    }
+
+    uint32_t header[2] = { MAGIC, VERSION };
+    std::fwrite(header, sizeof(header), 1, m_file);
+
+    Log::info(Log::GENERAL, "Recording events in: %s\n", path.c_str());
+    m_clock.restart();
+    return true;
+  }
+
+  void EventRecorder::close() {
+    if (m_file != nullptr) {
+      std::fclose(m_file);
+      m_file = nullptr;
+    }
+  }
+
+  void EventRecorder::record(EventType type, const void *data, std::size_t size) {
+    if (m_file == nullptr) {
+      return;
+    }
+
+    assert(size <= UINT32_MAX);
+
+    int64_t time = m_clock.getElapsedTime().asMicroseconds();
+    uint32_t length = static_cast<uint32_t>(size);
+
+    // the file is buffered, there is no need to gather the fields
+    std::fwrite(&time, sizeof(time), 1, m_file);
+    std::fwrite(&type, sizeof(type), 1, m_file);
+    std::fwrite(&length, sizeof(length), 1, m_file);
+    std::fwrite(data, 1, size, m_file);
+  }
+
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2014-2015, Julien Bernard
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#ifndef GAME_EVENT_RECORDER_H
+#define GAME_EVENT_RECORDER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <type_traits>
+
+#include "Clock.h"
+#include "Event.h"
+
+namespace game {
+
+  /**
+   * @brief A recorder of events in a binary trace.
+   *
+   * The trace starts with a header (a magic number and a version) followed
+   * by records. A record is made of the time of the record in microseconds
+   * since the opening of the trace, the type of the event, the size of the
+   * payload and the bytes of the payload. The values are written in the
+   * native byte order, so a trace is meant to be replayed on the same
+   * platform.
+   *
+   * @sa EventReplayer, EventManager::setRecorder, ActionManager::setRecorder
+   * @ingroup base
+   */
+  class EventRecorder {
+  public:
+    static constexpr uint32_t MAGIC = 0x54564547; // "GEVT"
+    static constexpr uint32_t VERSION = 1;
+
+    EventRecorder();
+    ~EventRecorder();
+
+    EventRecorder(const EventRecorder&) = delete;
+    EventRecorder& operator=(const EventRecorder&) = delete;
+
+    /**
+     * @brief Open a trace.
+     *
+     * The file is truncated and the time of the records starts now.
+     *
+     * @param path the path of the trace
+     * @returns true if the trace could be opened
+     */
+    bool open(const std::string& path);
+
+    /**
+     * @brief Close the trace.
+     */
+    void close();
+
+    bool isOpen() const {
+      return m_file != nullptr;
+    }
+
+    /**
+     * @brief Record a payload.
+     *
+     * Nothing is recorded if the trace is not open.
+     *
+     * @param type the type of the event
+     * @param data the bytes of the payload
+     * @param size the size of the payload
+     */
+    void record(EventType type, const void *data, std::size_t size);
+
+    /**
+     * @brief Record an event.
+     *
+     * The event must be trivially copyable, its bytes are the payload.
+     *
+     * @param event the event
+     */
+    template<typename E>
+    void recordEvent(const E& event) {
+      static_assert(std::is_trivially_copyable<E>::value, "E must be trivially copyable");
+      record(E::type, &event, sizeof(E));
+    }
+
+  private:
+    std::FILE *m_file;
+    Clock m_clock;
+  };
+
+}
+
+#endif // GAME_EVENT_RECORDER_H
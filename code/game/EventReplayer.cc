@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2014-2015, Julien Bernard
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#include "EventReplayer.h"
+
+#include <cassert>
+#include <cstdio>
+#include <limits>
+
+#include "EventRecorder.h"
+#include "Log.h"
+
+namespace game {
+
+  static constexpr std::size_t HEADER_SIZE = 2 * sizeof(uint32_t);
+  static constexpr std::size_t RECORD_SIZE = sizeof(int64_t) + sizeof(EventType) + sizeof(uint32_t);
+
+  EventReplayer::EventReplayer()
+  : m_offset(0)
+  , m_started(false)
+  {
+  }
+
+  bool EventReplayer::loadFromFile(const std::string& path) {
+    std::FILE *file = std::fopen(path.c_str(), "rb");
+
+    if (file == nullptr) {
+      Log::error(Log::GENERAL, "Could not open the trace: %s\n", path.c_str());
+      return false;
+    }
+
+    std::vector<char> data;
+    char buffer[4096];
+    std::size_t count;
+
+    while ((count = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+      data.insert(data.end(), buffer, buffer + count);
+    }
+
+    std::fclose(file);
+
+    uint32_t header[2] = { 0, 0 };
+
+    if (data.size() >= HEADER_SIZE) {
+      std::memcpy(header, data.data(), HEADER_SIZE);
+    }
+
+    if (header[0] != EventRecorder::MAGIC || header[1] != EventRecorder::VERSION) {
+      Log::error(Log::GENERAL, "Not a trace of events: %s\n", path.c_str());
+      return false;
+    }
+
+    // the records begin after the header
+    data.erase(data.begin(), data.begin() + HEADER_SIZE);
+    m_data.swap(data);
+    rewind();
+
+    Log::info(Log::GENERAL, "Loaded a trace of events: %s\n", path.c_str());
+    return true;
+  }
+
+  void EventReplayer::setHandler(EventType type, Handler handler) {
+    m_handlers[type] = handler;
+  }
+
+  std::size_t EventReplayer::update() {
+    if (!m_started) {
+      m_clock.restart();
+      m_started = true;
+    }
+
+    return replay(m_clock.getElapsedTime().asMicroseconds());
+  }
+
+  std::size_t EventReplayer::replayAll() {
+    return replay(std::numeric_limits<int64_t>::max());
+  }
+
+  void EventReplayer::rewind() {
+    m_offset = 0;
+    m_started = false;
+  }
+
+  std::size_t EventReplayer::replay(int64_t until) {
+    std::size_t count = 0;
+
+    while (m_offset < m_data.size()) {
+      const char *record = m_data.data() + m_offset;
+      std::size_t remaining = m_data.size() - m_offset;
+
+      if (remaining < RECORD_SIZE) {
+        Log::error(Log::GENERAL, "The trace of events is truncated\n");
+        m_offset = m_data.size();
+        break;
+      }
+
+      int64_t time;
+      std::memcpy(&time, record, sizeof(time));
+
+      if (time > until) {
+        break;
+      }
+
+      EventType type;
+      std::memcpy(&type, record + sizeof(time), sizeof(type));
+      uint32_t size;
+      std::memcpy(&size, record + sizeof(time) + sizeof(type), sizeof(size));
+
+      if (remaining - RECORD_SIZE < size) {
+        Log::error(Log::GENERAL, "The trace of events is truncated\n");
+        m_offset = m_data.size();
+        break;
+      }
+
+      m_offset += RECORD_SIZE + size;
+
+      Handler *handler = m_handlers.find(type);
+
+      if (handler != nullptr) {
+        (*handler)(record + RECORD_SIZE, size);
+        ++count;
+      }
+    }
+
+    return count;
+  }
+
+}
@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2014-2015, Julien Bernard
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#ifndef GAME_EVENT_REPLAYER_H
+#define GAME_EVENT_REPLAYER_H
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "Clock.h"
+#include "Delegate.h"
+#include "EventManager.h"
+#include "IdMap.h"
+
+namespace game {
+
+  /**
+   * @brief A replayer of a trace of events.
+   *
+   * The trace is written by an EventRecorder and entirely loaded in memory.
+   * Each type of event in the trace is given to a handler, the records of a
+   * type without a handler are skipped. The records can be replayed at
+   * their recorded time, or as fast as possible.
+   *
+   * @sa EventRecorder, ActionManager::replayFrom
+   * @ingroup base
+   */
+  class EventReplayer {
+  public:
+    /**
+     * @brief A handler of recorded payloads.
+     */
+    typedef Delegate<void(const void *, std::size_t)> Handler;
+
+    EventReplayer();
+
+    /**
+     * @brief Load a trace.
+     *
+     * @param path the path of the trace
+     * @returns true if the trace was loaded
+     */
+    bool loadFromFile(const std::string& path);
+
+    /**
+     * @brief Set the handler of a type of event.
+     *
+     * @param type the type of event
+     * @param handler the handler
+     */
+    void setHandler(EventType type, Handler handler);
+
+    /**
+     * @brief Trigger the recorded events of a type in a manager.
+     *
+     * This is for the events that were triggered when they were recorded.
+     *
+     * The event must be trivially copyable.
+     *
+     * @param manager the manager
+     */
+    template<typename E>
+    void replayTo(EventManager& manager) {
+      static_assert(std::is_trivially_copyable<E>::value, "E must be trivially copyable");
+      setHandler(E::type, [&manager](const void *data, std::size_t size) {
+        assert(size == sizeof(E));
+        typename std::aligned_storage<sizeof(E), alignof(E)>::type storage;
+        std::memcpy(&storage, data, sizeof(E));
+        manager.triggerEvent(reinterpret_cast<E *>(&storage));
+      });
+    }
+
+    /**
+     * @brief Post the recorded events of a type in a manager.
+     *
+     * This is the counterpart of replayTo() for the events that were posted
+     * when they were recorded. They are delivered by the next
+     * EventManager::dispatchQueued(). The event must be trivially copyable.
+     *
+     * @param manager the manager
+     */
+    template<typename E>
+    void replayQueuedTo(EventManager& manager) {
+      static_assert(std::is_trivially_copyable<E>::value, "E must be trivially copyable");
+      setHandler(E::type, [&manager](const void *data, std::size_t size) {
+        assert(size == sizeof(E));
+        typename std::aligned_storage<sizeof(E), alignof(E)>::type storage;
+        std::memcpy(&storage, data, sizeof(E));
+        manager.postEvent(*reinterpret_cast<E *>(&storage));
+      });
+    }
+
+    /**
+     * @brief Replay the records whose time has come.
+     *
+     * The time starts at the first call after a load or a rewind.
+     *
+     * @returns the number of records replayed
+     */
+    std::size_t update();
+
+    /**
+     * @brief Replay all the remaining records, as fast as possible.
+     *
+     * @returns the number of records replayed
+     */
+    std::size_t replayAll();
+
+    /**
+     * @brief Go back to the beginning of the trace.
+     */
+    void rewind();
+
+    bool isFinished() const {
+      return m_offset == m_data.size();
+    }
+
+  private:
+    std::size_t replay(int64_t until);
+
+  private:
+    std::vector<char> m_data;
+    std::size_t m_offset;
+    IdMap<Handler> m_handlers;
+    Clock m_clock;
+    bool m_started;
+  };
+
+}
+
+#endif // GAME_EVENT_REPLAYER_H
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2014-2015, Julien Bernard
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#include "GameLoop.h"
+
+#include <cassert>
+
+namespace game {
+
+  GameLoop::GameLoop(float timestep, unsigned maxSteps)
+  : m_timestep(static_cast<int64_t>(timestep * 1000000))
+  , m_max_steps(maxSteps)
+  , m_accumulator(0)
+  , m_steps(0)
+  , m_alpha(0.0f)
+  {
+    assert(m_timestep > 0);
+    assert(maxSteps > 0);
+  }
+
+  void GameLoop::addModels(ModelManager& models) {
+    m_models.push_back(&models);
+  }
+
+  void GameLoop::addEntities(EntityManager& entities) {
+    m_entities.push_back(&entities);
+  }
+
+  float GameLoop::getTimestep() const {
+    return m_timestep / 1000000.0f;
+  }
+
+  float GameLoop::update() {
+    m_accumulator += m_clock.restart().asMicroseconds();
+    m_steps = 0;
+
+    float dt = getTimestep();
+
+    while (m_accumulator >= m_timestep && m_steps < m_max_steps) {
+      for (auto models : m_models) {
+        models->update(dt);
+      }
+
+      for (auto entities : m_entities) {
+        entities->update(dt);
+      }
+
+      m_accumulator -= m_timestep;
+      ++m_steps;
+    }
+
+    if (m_accumulator >= m_timestep) {
+      // too late, drop the time that could not be simulated
+      m_accumulator %= m_timestep;
+    }
+
+    m_alpha = static_cast<float>(m_accumulator) / m_timestep;
+    return m_alpha;
+  }
+
+  void GameLoop::reset() {
+    m_clock.restart();
+    m_accumulator = 0;
+    m_alpha = 0.0f;
+  }
+
+}
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2014-2015, Julien Bernard
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#ifndef GAME_GAME_LOOP_H
+#define GAME_GAME_LOOP_H
+
+#include <cstdint>
+#include <vector>
+
+#include "Clock.h"
+#include "EntityManager.h"
+#include "ModelManager.h"
+
+namespace game {
+
+  /**
+   * @brief A fixed timestep driver for the simulation.
+   *
+   * At each frame, the elapsed time is accumulated and the managers are
+   * updated by steps of a fixed duration, models first. The number of steps
+   * per frame is capped, so that a long frame does not make the next frames
+   * even longer. The remaining time is given as an interpolation factor for
+   * the rendering.
+   *
+   * ~~~{.cc}
+   * game::GameLoop loop(1 / 60.0f);
+   * loop.addModels(models);
+   * loop.addEntities(entities);
+   *
+   * while (window.isOpen()) {
+   *   // input
+   *   float alpha = loop.update();
+   *   entities.render(window, alpha);
+   * }
+   * ~~~
+   *
+   * @ingroup base
+   */
+  class GameLoop {
+  public:
+    /**
+     * @brief Create a loop.
+     *
+     * @param timestep the duration of a step, in seconds
+     * @param maxSteps the maximum number of steps in a frame
+     */
+    GameLoop(float timestep, unsigned maxSteps = 5);
+
+    void addModels(ModelManager& models);
+    void addEntities(EntityManager& entities);
+
+    float getTimestep() const;
+
+    /**
+     * @brief Run the steps for the time elapsed since the last call.
+     *
+     * @returns the interpolation factor, in [0, 1)
+     */
+    float update();
+
+    /**
+     * @brief Get the interpolation factor of the last update.
+     *
+     * It is the fraction of a step that has not been simulated yet. It is
+     * given to the entities by EntityManager::render().
+     *
+     * @sa Entity::interpolate()
+     */
+    float getAlpha() const {
+      return m_alpha;
+    }
+
+    /**
+     * @brief Get the number of steps run by the last update.
+     */
+    unsigned getStepCount() const {
+      return m_steps;
+    }
+
+    /**
+     * @brief Forget the time elapsed since the last update.
+     *
+     * This is useful after a pause or a loading.
+     */
+    void reset();
+
+  private:
+    Clock m_clock;
+    int64_t m_timestep; // in microseconds
+    unsigned m_max_steps;
+    int64_t m_accumulator; // in microseconds
+    unsigned m_steps;
+    float m_alpha;
+
+    std::vector<ModelManager *> m_models;
+    std::vector<EntityManager *> m_entities;
+  };
+
+}
+
+#endif // GAME_GAME_LOOP_H
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2014-2015, Julien Bernard
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#ifndef GAME_HANDLE_H
+#define GAME_HANDLE_H
+
+#include <cstdint>
+
+namespace game {
+
+  /**
+   * @brief A generational handle to an object stored in a slot map.
+   *
+   * The index designates a slot and the generation tells which object of
+   * the slot is referenced. When an object is removed, the generation of its
+   * slot is incremented, so that the old handles become stale. A
+   * default-constructed handle is never valid.
+   *
+   * @ingroup base
+   */
+  template<typename T>
+  struct Handle {
+    Handle()
+    : index(0)
+    , generation(0)
+    {
+    }
+
+    Handle(uint32_t index, uint32_t generation)
+    : index(index)
+    , generation(generation)
+    {
+    }
+
+    uint32_t index;
+    uint32_t generation;
+  };
+
+  /**
+   * @brief Test handles' equality
+   *
+   * @ingroup base
+   */
+  template<typename T>
+  inline
+  bool operator==(const Handle<T>& lhs, const Handle<T>& rhs) {
+    return lhs.index == rhs.index && lhs.generation == rhs.generation;
+  }
+
+  /**
+   * @brief Test handles' inequality
+   *
+   * @ingroup base
+   */
+  template<typename T>
+  inline
+  bool operator!=(const Handle<T>& lhs, const Handle<T>& rhs) {
+    return lhs.index != rhs.index || lhs.generation != rhs.generation;
+  }
+
+}
+
+#endif // GAME_HANDLE_H
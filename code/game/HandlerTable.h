@@ -0,0 +1,244 @@
+/*
+ * Copyright (c) 2014-2015, Julien Bernard
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#ifndef GAME_HANDLER_TABLE_H
+#define GAME_HANDLER_TABLE_H
+
+#include <cassert>
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "Event.h"
+
+namespace game {
+
+  /**
+   * @brief The storage of the event handlers.
+   *
+   * The handlers are stored in lists, one per event type, and each handler
+   * has a slot in the table. The id of a handler encodes its slot (low 32
+   * bits) and the generation of the slot (high 32 bits), so that a handler
+   * is found in constant time and a stale id is ignored.
+   *
+   * A handler can be added or removed while its list is dispatched. The
+   * handlers added during a dispatch wait in a separate vector and are not
+   * called. The removed handlers are only marked dead. Both are merged when
+   * the outermost dispatch of the list ends. Outside of a dispatch, the dead
+   * handlers are erased when they are half of the list, so a list that is
+   * never dispatched does not grow and a removal stays amortized O(1).
+   *
+   * @sa EventManager, EventChannel
+   * @ingroup base
+   */
+  template<typename H>
+  class HandlerTable {
+  public:
+    struct Entry {
+      uint32_t slot;
+      H handler;
+      bool alive;
+    };
+
+    struct List {
+      List()
+      : depth(0)
+      , dead(0)
+      {
+      }
+
+      std::vector<Entry> handlers;
+      // the handlers added during a dispatch of the list
+      std::vector<Entry> added;
+      // the number of dispatches in progress for the list
+      unsigned depth;
+      // the number of dead handlers in the handlers vector
+      std::size_t dead;
+    };
+
+    HandlerTable() = default;
+
+    HandlerTable(const HandlerTable&) = delete;
+    HandlerTable& operator=(const HandlerTable&) = delete;
+
+    /**
+     * @brief Add a handler to a list.
+     *
+     * The list must not move while it has handlers.
+     *
+     * @param list the list
+     * @param handler the handler
+     * @returns the id of the handler
+     */
+    uint64_t add(List& list, H handler) {
+      uint32_t index;
+
+      if (m_free.empty()) {
+        index = m_slots.size();
+        m_slots.push_back({ 1, nullptr, 0, false });
+      } else {
+        index = m_free.back();
+        m_free.pop_back();
+      }
+
+      Slot& slot = m_slots[index];
+      slot.list = &list;
+
+      if (list.depth > 0) {
+        // do not move the handlers that are being called
+        slot.position = list.added.size();
+        slot.added = true;
+        list.added.push_back({ index, std::move(handler), true });
+      } else {
+        slot.position = list.handlers.size();
+        slot.added = false;
+        list.handlers.push_back({ index, std::move(handler), true });
+      }
+
+      return (static_cast<uint64_t>(slot.generation) << 32) | index;
+    }
+
+    /**
+     * @brief Remove a handler.
+     *
+     * @param id the id of the handler, it is ignored if it is stale
+     */
+    void remove(uint64_t id) {
+      uint32_t index = static_cast<uint32_t>(id & 0xFFFFFFFF);
+      uint32_t generation = static_cast<uint32_t>(id >> 32);
+
+      if (index >= m_slots.size() || m_slots[index].generation != generation || m_slots[index].list == nullptr) {
+        return;
+      }
+
+      // the handler is erased at the next compaction of its list
+      Slot& slot = m_slots[index];
+
+      if (slot.added) {
+        slot.list->added[slot.position].alive = false;
+      } else {
+        slot.list->handlers[slot.position].alive = false;
+        ++slot.list->dead;
+      }
+
+      List& list = *slot.list;
+      release(index);
+
+      if (list.depth == 0 && list.dead * 2 > list.handlers.size()) {
+        compact(list);
+      }
+    }
+
+    /**
+     * @brief Call the handlers of a list.
+     *
+     * The function is called with each live entry of the list and returns
+     * the status of the handler. A handler that returns EventStatus::DIE is
+     * removed.
+     *
+     * @param list the list
+     * @param func the function, with the signature `EventStatus(Entry&)`
+     */
+    template<typename Func>
+    void dispatch(List& list, Func func) {
+      ++list.depth;
+
+      // the handlers added during the dispatch are not called
+      std::size_t size = list.handlers.size();
+
+      for (std::size_t i = 0; i < size; ++i) {
+        Entry& entry = list.handlers[i];
+
+        if (!entry.alive) {
+          continue;
+        }
+
+        // the handler may have been removed during its call
+        if (func(entry) == EventStatus::DIE && entry.alive) {
+          entry.alive = false;
+          ++list.dead;
+          release(entry.slot);
+        }
+      }
+
+      if (--list.depth == 0 && (list.dead > 0 || !list.added.empty())) {
+        compact(list);
+      }
+    }
+
+  private:
+    // where a handler is
+    struct Slot {
+      uint32_t generation;
+      List *list; // nullptr when free
+      uint32_t position;
+      bool added; // in the added vector of the list
+    };
+
+    void compact(List& list) {
+      assert(list.depth == 0);
+
+      if (list.dead > 0) {
+        // erase-remove idiom
+        list.handlers.erase(std::remove_if(list.handlers.begin(), list.handlers.end(), [](const Entry& entry) {
+          return !entry.alive;
+        }), list.handlers.end());
+
+        for (std::size_t i = 0; i < list.handlers.size(); ++i) {
+          m_slots[list.handlers[i].slot].position = i;
+        }
+
+        list.dead = 0;
+      }
+
+      for (auto& entry : list.added) {
+        if (entry.alive) {
+          Slot& slot = m_slots[entry.slot];
+          slot.position = list.handlers.size();
+          slot.added = false;
+          list.handlers.push_back(std::move(entry));
+        }
+      }
+
+      list.added.clear();
+    }
+
+    void release(uint32_t index) {
+      Slot& slot = m_slots[index];
+      slot.list = nullptr;
+
+      // the generation 0 is never valid
+      if (++slot.generation == 0) {
+        slot.generation = 1;
+      }
+
+      m_free.push_back(index);
+    }
+
+  private:
+    std::vector<Slot> m_slots;
+    std::vector<uint32_t> m_free;
+  };
+
+}
+
+#endif // GAME_HANDLER_TABLE_H
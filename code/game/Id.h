@@ -23,6 +23,7 @@
 #define GAME_ID_H
 
 #include <cstdint>
+#include <string>
 
 namespace game {
 
@@ -0,0 +1,240 @@
+/*
+ * Copyright (c) 2014-2015, Julien Bernard
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#ifndef GAME_ID_MAP_H
+#define GAME_ID_MAP_H
+
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "Id.h"
+
+namespace game {
+
+  /**
+   * @brief A flat hash map with Id keys.
+   *
+   * The keys are already hashes, so they are used directly to find their
+   * bucket. The map uses open addressing with linear probing: the keys are
+   * stored in a contiguous array where INVALID_ID marks an empty bucket, and
+   * the values in a parallel array. INVALID_ID can not be used as a key.
+   *
+   * The references to the values are invalidated when the map grows.
+   *
+   * @ingroup base
+   */
+  template<typename T>
+  class IdMap {
+  public:
+    IdMap()
+    : m_size(0)
+    , m_shift(64)
+    {
+    }
+
+    std::size_t getSize() const {
+      return m_size;
+    }
+
+    bool isEmpty() const {
+      return m_size == 0;
+    }
+
+    /**
+     * @brief Find the value of a key.
+     *
+     * @param key the key
+     * @returns the value, or @c nullptr if the key is not in the map
+     */
+    T *find(Id key) {
+      std::size_t index = findIndex(key);
+      return index == NOT_FOUND ? nullptr : &m_values[index];
+    }
+
+    /**
+     * @brief Find the value of a key.
+     *
+     * @param key the key
+     * @returns the value, or @c nullptr if the key is not in the map
+     */
+    const T *find(Id key) const {
+      std::size_t index = findIndex(key);
+      return index == NOT_FOUND ? nullptr : &m_values[index];
+    }
+
+    /**
+     * @brief Get the value of a key, inserting a default value if needed.
+     *
+     * @param key the key
+     * @returns the value
+     */
+    T& operator[](Id key) {
+      assert(key != INVALID_ID);
+
+      if ((m_size + 1) * 2 > m_keys.size()) {
+        grow();
+      }
+
+      std::size_t mask = m_keys.size() - 1;
+
+      for (std::size_t index = computeBucket(key); ; index = (index + 1) & mask) {
+        if (m_keys[index] == key) {
+          return m_values[index];
+        }
+
+        if (m_keys[index] == INVALID_ID) {
+          m_keys[index] = key;
+          m_values[index] = T();
+          ++m_size;
+          return m_values[index];
+        }
+      }
+    }
+
+    /**
+     * @brief Remove a key.
+     *
+     * @param key the key
+     * @returns true if the key was in the map
+     */
+    bool erase(Id key) {
+      std::size_t index = findIndex(key);
+
+      if (index == NOT_FOUND) {
+        return false;
+      }
+
+      // shift the next keys of the cluster back into the hole
+      std::size_t mask = m_keys.size() - 1;
+      std::size_t hole = index;
+
+      for (std::size_t next = (hole + 1) & mask; m_keys[next] != INVALID_ID; next = (next + 1) & mask) {
+        std::size_t bucket = computeBucket(m_keys[next]);
+
+        // the key can move to the hole if its bucket is not in (hole, next]
+        if (((next - bucket) & mask) >= ((next - hole) & mask)) {
+          m_keys[hole] = m_keys[next];
+          m_values[hole] = std::move(m_values[next]);
+          hole = next;
+        }
+      }
+
+      m_keys[hole] = INVALID_ID;
+      m_values[hole] = T();
+      --m_size;
+      return true;
+    }
+
+    /**
+     * @brief Remove all the keys.
+     */
+    void clear() {
+      m_keys.clear();
+      m_values.clear();
+      m_size = 0;
+      m_shift = 64;
+    }
+
+    /**
+     * @brief Call a function for each key and value.
+     *
+     * @param func the function, called with the key and the value
+     */
+    template<typename Func>
+    void forEach(Func func) {
+      for (std::size_t i = 0; i < m_keys.size(); ++i) {
+        if (m_keys[i] != INVALID_ID) {
+          func(m_keys[i], m_values[i]);
+        }
+      }
+    }
+
+  private:
+    static constexpr std::size_t NOT_FOUND = static_cast<std::size_t>(-1);
+    static constexpr std::size_t INITIAL_CAPACITY = 16;
+
+    std::size_t computeBucket(Id key) const {
+      // Fibonacci hashing, to use the high bits of the key
+      return static_cast<std::size_t>((key * UINT64_C(0x9E3779B97F4A7C15)) >> m_shift);
+    }
+
+    std::size_t findIndex(Id key) const {
+      if (m_size == 0 || key == INVALID_ID) {
+        return NOT_FOUND;
+      }
+
+      std::size_t mask = m_keys.size() - 1;
+
+      for (std::size_t index = computeBucket(key); ; index = (index + 1) & mask) {
+        if (m_keys[index] == key) {
+          return index;
+        }
+
+        if (m_keys[index] == INVALID_ID) {
+          return NOT_FOUND;
+        }
+      }
+    }
+
+    void grow() {
+      std::size_t capacity = m_keys.empty() ? INITIAL_CAPACITY : m_keys.size() * 2;
+
+      std::vector<Id> keys(capacity, INVALID_ID);
+      std::vector<T> values(capacity);
+      std::swap(keys, m_keys);
+      std::swap(values, m_values);
+
+      m_shift = 64;
+
+      for (std::size_t c = capacity; c > 1; c >>= 1) {
+        --m_shift;
+      }
+
+      std::size_t mask = capacity - 1;
+
+      for (std::size_t i = 0; i < keys.size(); ++i) {
+        if (keys[i] == INVALID_ID) {
+          continue;
+        }
+
+        std::size_t index = computeBucket(keys[i]);
+
+        while (m_keys[index] != INVALID_ID) {
+          index = (index + 1) & mask;
+        }
+
+        m_keys[index] = keys[i];
+        m_values[index] = std::move(values[i]);
+      }
+    }
+
+  private:
+    std::size_t m_size;
+    unsigned m_shift;
+    std::vector<Id> m_keys;
+    std::vector<T> m_values;
+  };
+
+}
+
+#endif // GAME_ID_MAP_H
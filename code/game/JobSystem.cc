@@ -0,0 +1,245 @@
+/*
+ * Copyright (c) 2014-2015, Julien Bernard
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#include "JobSystem.h"
+
+#include <cassert>
+#include <algorithm>
+
+namespace game {
+
+  namespace {
+
+    // the job system and the queue of the current worker thread
+    thread_local JobSystem *tCurrentSystem = nullptr;
+    thread_local std::size_t tCurrentQueue = 0;
+
+  }
+
+  JobSystem::JobSystem()
+  : JobSystem(std::max(std::thread::hardware_concurrency(), 1u) - 1)
+  {
+  }
+
+  JobSystem::JobSystem(unsigned workers)
+  : m_pending(0)
+  , m_sleeping(0)
+  , m_stop(false)
+  {
+    for (unsigned i = 0; i <= workers; ++i) {
+      m_queues.emplace_back(new WorkQueue);
+    }
+
+    for (unsigned i = 0; i < workers; ++i) {
+      m_threads.emplace_back(&JobSystem::run, this, i);
+    }
+  }
+
+  JobSystem::~JobSystem() {
+    {
+      std::unique_lock<std::mutex> lock(m_sleep_mutex);
+      m_stop = true;
+    }
+
+    m_wake.notify_all();
+
+    for (auto& thread : m_threads) {
+      thread.join();
+    }
+
+    // without workers, the remaining jobs are executed here
+    while (tryExecute()) {
+      // nothing
+    }
+  }
+
+  void JobSystem::submit(Job job, JobCounter *counter) {
+    assert(job);
+
+    if (counter != nullptr) {
+      counter->m_count.fetch_add(1);
+    }
+
+    push({ std::move(job), counter });
+  }
+
+  void JobSystem::submitAfter(JobCounter& dependency, Job job, JobCounter *counter) {
+    assert(job);
+
+    if (counter != nullptr) {
+      counter->m_count.fetch_add(1);
+    }
+
+    {
+      std::unique_lock<std::mutex> lock(dependency.m_mutex);
+
+      if (dependency.m_count.load() > 0) {
+        dependency.m_continuations.push_back({ std::move(job), counter });
+        return;
+      }
+    }
+
+    push({ std::move(job), counter });
+  }
+
+  void JobSystem::wait(JobCounter& counter) {
+    while (!counter.isDone()) {
+      if (!tryExecute()) {
+        std::this_thread::yield();
+      }
+    }
+
+    // the last job may still be releasing the counter
+    std::unique_lock<std::mutex> lock(counter.m_mutex);
+  }
+
+  void JobSystem::parallelFor(std::size_t count, const std::function<void(std::size_t)>& fn, std::size_t grain) {
+    if (grain == 0) {
+      // a few chunks per thread to balance the load
+      grain = std::max<std::size_t>(count / ((m_threads.size() + 1) * 4), 1);
+    }
+
+    JobCounter counter;
+
+    for (std::size_t first = 0; first < count; first += grain) {
+      std::size_t last = std::min(first + grain, count);
+
+      submit([&fn, first, last]() {
+        for (std::size_t i = first; i < last; ++i) {
+          fn(i);
+        }
+      }, &counter);
+    }
+
+    wait(counter);
+  }
+
+  void JobSystem::run(unsigned index) {
+    tCurrentSystem = this;
+    tCurrentQueue = index;
+
+    for (;;) {
+      if (tryExecute()) {
+        continue;
+      }
+
+      std::unique_lock<std::mutex> lock(m_sleep_mutex);
+      m_sleeping.fetch_add(1);
+
+      m_wake.wait(lock, [this]() {
+        return m_stop || m_pending.load() > 0;
+      });
+
+      m_sleeping.fetch_sub(1);
+
+      if (m_stop && m_pending.load() == 0) {
+        return;
+      }
+    }
+  }
+
+  void JobSystem::push(Task task) {
+    std::size_t index = (tCurrentSystem == this) ? tCurrentQueue : m_queues.size() - 1;
+    WorkQueue& queue = *m_queues[index];
+
+    {
+      std::unique_lock<std::mutex> lock(queue.mutex);
+      queue.tasks.push_back(std::move(task));
+    }
+
+    m_pending.fetch_add(1);
+
+    if (m_sleeping.load() > 0) {
+      std::unique_lock<std::mutex> lock(m_sleep_mutex);
+      m_wake.notify_one();
+    }
+  }
+
+  bool JobSystem::tryExecute() {
+    Task task;
+
+    if (!tryTake(task)) {
+      return false;
+    }
+
+    execute(task);
+    return true;
+  }
+
+  bool JobSystem::tryTake(Task& task) {
+    std::size_t count = m_queues.size();
+    std::size_t own = (tCurrentSystem == this) ? tCurrentQueue : count - 1;
+
+    // the last job of the own queue, which is the most likely to be in cache
+    {
+      WorkQueue& queue = *m_queues[own];
+      std::unique_lock<std::mutex> lock(queue.mutex);
+
+      if (!queue.tasks.empty()) {
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+        m_pending.fetch_sub(1);
+        return true;
+      }
+    }
+
+    // steal the first job of another queue
+    for (std::size_t i = 1; i < count; ++i) {
+      WorkQueue& queue = *m_queues[(own + i) % count];
+      std::unique_lock<std::mutex> lock(queue.mutex);
+
+      if (!queue.tasks.empty()) {
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        m_pending.fetch_sub(1);
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  void JobSystem::execute(Task& task) {
+    task.job();
+    finish(task.counter);
+  }
+
+  void JobSystem::finish(JobCounter *counter) {
+    if (counter == nullptr) {
+      return;
+    }
+
+    std::vector<JobCounter::Continuation> continuations;
+
+    {
+      std::unique_lock<std::mutex> lock(counter->m_mutex);
+
+      if (counter->m_count.fetch_sub(1) == 1) {
+        continuations.swap(counter->m_continuations);
+      }
+    }
+
+    for (auto& continuation : continuations) {
+      push({ std::move(continuation.job), continuation.counter });
+    }
+  }
+
+}
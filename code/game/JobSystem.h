@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) 2014-2015, Julien Bernard
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#ifndef GAME_JOB_SYSTEM_H
+#define GAME_JOB_SYSTEM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace game {
+
+  /**
+   * @ingroup base
+   */
+  typedef std::function<void()> Job;
+
+  /**
+   * @brief A counter of unfinished jobs.
+   *
+   * A counter is incremented when a job is submitted with it and decremented
+   * when the job is finished. It is used to wait for a group of jobs, or to
+   * make a job depend on a group of jobs.
+   *
+   * @sa JobSystem
+   * @ingroup base
+   */
+  class JobCounter {
+  public:
+    JobCounter()
+    : m_count(0)
+    {
+    }
+
+    JobCounter(const JobCounter&) = delete;
+    JobCounter& operator=(const JobCounter&) = delete;
+
+    /**
+     * @brief Tell whether all the jobs of the counter are finished.
+     */
+    bool isDone() const {
+      return m_count.load(std::memory_order_acquire) == 0;
+    }
+
+  private:
+    friend class JobSystem;
+
+    struct Continuation {
+      Job job;
+      JobCounter *counter;
+    };
+
+    std::atomic<unsigned> m_count;
+    std::mutex m_mutex;
+    std::vector<Continuation> m_continuations;
+  };
+
+  /**
+   * @brief A work-stealing job system.
+   *
+   * Each worker has its own deque of jobs. A worker takes the last job of its
+   * deque and, when it is empty, steals the first job of another deque. The
+   * jobs submitted from a thread that is not a worker go to a shared deque.
+   *
+   * A thread that waits for a counter executes jobs in the meantime, so the
+   * main thread takes part in the work and a job can wait for other jobs.
+   *
+   * ~~~{.cc}
+   * game::JobCounter decoded;
+   * jobs.submit([]() { decode(); }, &decoded);
+   *
+   * game::JobCounter uploaded;
+   * jobs.submitAfter(decoded, []() { prepare(); }, &uploaded);
+   *
+   * jobs.wait(uploaded);
+   * ~~~
+   *
+   * @ingroup base
+   */
+  class JobSystem {
+  public:
+    /**
+     * @brief Create a job system with one worker per hardware thread but one.
+     */
+    JobSystem();
+
+    /**
+     * @brief Create a job system.
+     *
+     * @param workers the number of worker threads
+     */
+    explicit JobSystem(unsigned workers);
+
+    /**
+     * @brief Finish the queued jobs and join the workers.
+     */
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    unsigned getWorkerCount() const {
+      return m_threads.size();
+    }
+
+    /**
+     * @brief Submit a job.
+     *
+     * @param job the job
+     * @param counter a counter for the job, or @c nullptr
+     */
+    void submit(Job job, JobCounter *counter = nullptr);
+
+    /**
+     * @brief Submit a job that runs after other jobs.
+     *
+     * The job is submitted when all the jobs of the dependency are finished.
+     *
+     * @param dependency the counter of the jobs to wait for
+     * @param job the job
+     * @param counter a counter for the job, or @c nullptr
+     */
+    void submitAfter(JobCounter& dependency, Job job, JobCounter *counter = nullptr);
+
+    /**
+     * @brief Wait for the jobs of a counter, executing jobs in the meantime.
+     *
+     * @param counter the counter to wait for
+     */
+    void wait(JobCounter& counter);
+
+    /**
+     * @brief Call a function for every index of a range, in parallel.
+     *
+     * The range is split in chunks of @c grain indices. The function returns
+     * when all the calls are done.
+     *
+     * @param count the number of indices
+     * @param fn the function to call with each index in [0, count)
+     * @param grain the number of indices per job, or 0 to choose it
+     */
+    void parallelFor(std::size_t count, const std::function<void(std::size_t)>& fn, std::size_t grain = 0);
+
+  private:
+    struct Task {
+      Job job;
+      JobCounter *counter;
+    };
+
+    struct WorkQueue {
+      std::mutex mutex;
+      std::deque<Task> tasks;
+    };
+
+    void run(unsigned index);
+    void push(Task task);
+    bool tryExecute();
+    bool tryTake(Task& task);
+    void execute(Task& task);
+    void finish(JobCounter *counter);
+
+  private:
+    std::vector<std::thread> m_threads;
+    // one per worker, and the last one for the other threads
+    std::vector<std::unique_ptr<WorkQueue>> m_queues;
+
+    std::atomic<std::size_t> m_pending;
+    std::atomic<unsigned> m_sleeping;
+    std::mutex m_sleep_mutex;
+    std::condition_variable m_wake;
+    bool m_stop;
+  };
+
+}
+
+#endif // GAME_JOB_SYSTEM_H
@@ -28,6 +28,8 @@
 namespace game {
 
   void ModelManager::update(float dt) {
+    flush();
+
     for (auto model : m_models) {
       model->update(dt);
     }
@@ -49,4 +51,30 @@ namespace game {
     return nullptr;
   }
 
+  void ModelManager::deferAddModel(Model& e) {
+    m_added.push_back(&e);
+  }
+
+  void ModelManager::deferRemoveModel(Model *e) {
+    m_removed.push_back(e);
+  }
+
+  void ModelManager::flush() {
+    m_models.insert(m_models.end(), m_added.begin(), m_added.end());
+    m_added.clear();
+
+    if (m_removed.empty()) {
+      return;
+    }
+
+    std::sort(m_removed.begin(), m_removed.end());
+
+    // erase-remove idiom
+    m_models.erase(std::remove_if(m_models.begin(), m_models.end(), [this](const Model *e) {
+      return std::binary_search(m_removed.begin(), m_removed.end(), e);
+    }), m_models.end());
+
+    m_removed.clear();
+  }
+
 }
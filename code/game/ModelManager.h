@@ -36,11 +36,58 @@ namespace game {
 
     void update(float dt);
 
+    /**
+     * @brief Add a model immediately.
+     *
+     * This function must not be called during update().
+     *
+     * @param e the model to add
+     * @sa deferAddModel()
+     */
     void addModel(Model& e);
+
+    /**
+     * @brief Remove a model immediately.
+     *
+     * This function must not be called during update().
+     *
+     * @param e the model to remove
+     * @returns the removed model or @c nullptr if it was not found
+     * @sa deferRemoveModel()
+     */
     Model *removeModel(Model *e);
 
+    /**
+     * @brief Add a model at the next flush.
+     *
+     * This function can be called safely during update().
+     *
+     * @param e the model to add
+     * @sa flush()
+     */
+    void deferAddModel(Model& e);
+
+    /**
+     * @brief Remove a model at the next flush.
+     *
+     * This function can be called safely during update().
+     *
+     * @param e the model to remove
+     * @sa flush()
+     */
+    void deferRemoveModel(Model *e);
+
+    /**
+     * @brief Apply the deferred additions and removals.
+     *
+     * This function is called at the beginning of update().
+     */
+    void flush();
+
   private:
     std::vector<Model *> m_models;
+    std::vector<Model *> m_added;
+    std::vector<Model *> m_removed;
   };
 
 
@@ -0,0 +1,274 @@
+/*
+ * Copyright (c) 2014-2015, Julien Bernard
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#ifndef GAME_MPMC_QUEUE_H
+#define GAME_MPMC_QUEUE_H
+
+#include <cassert>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace game {
+
+  /**
+   * @brief A bounded multi-producer/multi-consumer queue.
+   *
+   * This is a lock-free alternative to Queue when several threads push and
+   * several threads pop. The elements are stored in a ring buffer allocated
+   * at construction, where each cell has a sequence number that tells
+   * whether it is ready to be written or read. A producer (or a consumer)
+   * claims a cell with a single compare-and-swap on the tail (or the head).
+   *
+   * drain() claims all the ready elements with a single compare-and-swap, so
+   * that a consumer can empty the queue once per frame without paying for
+   * each element.
+   *
+   * @sa Queue, SpscQueue
+   * @ingroup base
+   */
+  template<typename T>
+  class MpmcQueue {
+  public:
+    /**
+     * @brief Create a queue.
+     *
+     * @param capacity the minimum capacity of the queue, rounded up to a
+     * power of two
+     */
+    explicit MpmcQueue(std::size_t capacity)
+    : m_capacity(roundCapacity(capacity))
+    , m_mask(m_capacity - 1)
+    , m_cells(new Cell[m_capacity])
+    , m_tail(0)
+    , m_head(0)
+    {
+      for (std::size_t i = 0; i < m_capacity; ++i) {
+        m_cells[i].sequence.store(i, std::memory_order_relaxed);
+      }
+    }
+
+    ~MpmcQueue() {
+      std::size_t tail = m_tail.load(std::memory_order_relaxed);
+
+      for (std::size_t pos = m_head.load(std::memory_order_relaxed); pos != tail; ++pos) {
+        reinterpret_cast<T *>(&m_cells[pos & m_mask].storage)->~T();
+      }
+    }
+
+    MpmcQueue(const MpmcQueue&) = delete;
+    MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+    std::size_t getCapacity() const {
+      return m_capacity;
+    }
+
+    /**
+     * @brief Put an element in the queue.
+     *
+     * @param value the element
+     * @returns false if the queue was full
+     */
+    bool tryPush(const T& value) {
+      return tryEmplace(value);
+    }
+
+    /**
+     * @brief Put an element in the queue.
+     *
+     * @param value the element
+     * @returns false if the queue was full
+     */
+    bool tryPush(T&& value) {
+      return tryEmplace(std::move(value));
+    }
+
+    /**
+     * @brief Construct an element in the queue.
+     *
+     * @param args the arguments of the constructor of the element
+     * @returns false if the queue was full
+     */
+    template<typename ... Args>
+    bool tryEmplace(Args&&... args) {
+      std::size_t pos = m_tail.load(std::memory_order_relaxed);
+      Cell *cell;
+
+      for (;;) {
+        cell = &m_cells[pos & m_mask];
+        std::size_t seq = cell->sequence.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+
+        if (diff == 0) {
+          if (m_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+            break;
+          }
+        } else if (diff < 0) {
+          // the cell has not been read since the last round: full
+          return false;
+        } else {
+          pos = m_tail.load(std::memory_order_relaxed);
+        }
+      }
+
+      new (&cell->storage) T(std::forward<Args>(args)...);
+      cell->sequence.store(pos + 1, std::memory_order_release);
+      return true;
+    }
+
+    /**
+     * @brief Get an element from the queue.
+     *
+     * @param value the element
+     * @returns false if the queue was empty
+     */
+    bool tryPop(T& value) {
+      std::size_t pos = m_head.load(std::memory_order_relaxed);
+      Cell *cell;
+
+      for (;;) {
+        cell = &m_cells[pos & m_mask];
+        std::size_t seq = cell->sequence.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+
+        if (diff == 0) {
+          if (m_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+            break;
+          }
+        } else if (diff < 0) {
+          // the cell has not been written yet: empty
+          return false;
+        } else {
+          pos = m_head.load(std::memory_order_relaxed);
+        }
+      }
+
+      T *ptr = reinterpret_cast<T *>(&cell->storage);
+      value = std::move(*ptr);
+      release(*cell, pos);
+      return true;
+    }
+
+    /**
+     * @brief Get all the ready elements from the queue.
+     *
+     * The elements are claimed at once and then moved to the output, in
+     * order.
+     *
+     * @param out the output iterator
+     * @returns the number of elements
+     */
+    template<typename OutputIt>
+    std::size_t drain(OutputIt out) {
+      std::size_t pos = m_head.load(std::memory_order_relaxed);
+      std::size_t count;
+
+      for (;;) {
+        count = 0;
+
+        while (count < m_capacity) {
+          std::size_t seq = m_cells[(pos + count) & m_mask].sequence.load(std::memory_order_acquire);
+
+          if (seq != pos + count + 1) {
+            break;
+          }
+
+          ++count;
+        }
+
+        if (count == 0) {
+          std::size_t current = m_head.load(std::memory_order_relaxed);
+
+          if (current == pos) {
+            return 0;
+          }
+
+          // another consumer was faster
+          pos = current;
+          continue;
+        }
+
+        if (m_head.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed)) {
+          break;
+        }
+      }
+
+      for (std::size_t i = 0; i < count; ++i) {
+        Cell& cell = m_cells[(pos + i) & m_mask];
+        *out = std::move(*reinterpret_cast<T *>(&cell.storage));
+        ++out;
+        release(cell, pos + i);
+      }
+
+      return count;
+    }
+
+  private:
+    static constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+    typedef typename std::aligned_storage<sizeof(T), alignof(T)>::type Storage;
+
+    struct Cell {
+      std::atomic<std::size_t> sequence;
+      Storage storage;
+    };
+
+    void release(Cell& cell, std::size_t pos) {
+      reinterpret_cast<T *>(&cell.storage)->~T();
+
+      // the cell can be written in the next round
+      cell.sequence.store(pos + m_capacity, std::memory_order_release);
+    }
+
+    static std::size_t roundCapacity(std::size_t capacity) {
+      assert(capacity > 0);
+      std::size_t rounded = 1;
+
+      while (rounded < capacity) {
+        rounded <<= 1;
+      }
+
+      return rounded;
+    }
+
+  private:
+    const std::size_t m_capacity;
+    const std::size_t m_mask;
+    std::unique_ptr<Cell[]> m_cells;
+
+    char m_padding0[CACHE_LINE_SIZE];
+
+    std::atomic<std::size_t> m_tail;
+
+    char m_padding1[CACHE_LINE_SIZE];
+
+    std::atomic<std::size_t> m_head;
+
+    char m_padding2[CACHE_LINE_SIZE];
+  };
+
+}
+
+#endif // GAME_MPMC_QUEUE_H
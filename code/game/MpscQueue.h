@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2014-2015, Julien Bernard
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#ifndef GAME_MPSC_QUEUE_H
+#define GAME_MPSC_QUEUE_H
+
+#include <atomic>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace game {
+
+  /**
+   * @brief An unbounded multi-producer/single-consumer queue.
+   *
+   * This is a lock-free alternative to Queue when several threads push and
+   * exactly one thread polls. The elements are stored in a linked list of
+   * nodes, with a stub node at the front. A producer swaps the back of the
+   * list with a single atomic exchange and then links the previous node,
+   * so a push never waits for another thread. A node that has been swapped
+   * but not linked yet is not visible to the consumer until the producer
+   * links it.
+   *
+   * Each push allocates a node.
+   *
+   * @sa Queue, MpmcQueue
+   * @ingroup base
+   */
+  template<typename T>
+  class MpscQueue {
+  public:
+    MpscQueue()
+    : m_back(new Node)
+    , m_front(m_back.load(std::memory_order_relaxed))
+    {
+    }
+
+    ~MpscQueue() {
+      // the front node is the stub, it has no value
+      Node *node = m_front;
+      Node *next = node->next.load(std::memory_order_acquire);
+      delete node;
+
+      while (next != nullptr) {
+        node = next;
+        next = node->next.load(std::memory_order_acquire);
+        node->getValue()->~T();
+        delete node;
+      }
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    /**
+     * @brief Get an element from the queue (consumer side).
+     *
+     * @param value the element
+     * @returns false if the queue was empty
+     */
+    bool poll(T& value) {
+      Node *stub = m_front;
+      Node *next = stub->next.load(std::memory_order_acquire);
+
+      if (next == nullptr) {
+        return false;
+      }
+
+      // the next node becomes the stub
+      T *ptr = next->getValue();
+      value = std::move(*ptr);
+      ptr->~T();
+
+      m_front = next;
+      delete stub;
+      return true;
+    }
+
+    /**
+     * @brief Call a function on an element and remove it (consumer side).
+     *
+     * The element is given in place, so it does not need to be movable.
+     *
+     * @param func the function, with the signature `void(T&)`
+     * @returns false if the queue was empty
+     */
+    template<typename Func>
+    bool consume(Func func) {
+      Node *stub = m_front;
+      Node *next = stub->next.load(std::memory_order_acquire);
+
+      if (next == nullptr) {
+        return false;
+      }
+
+      // the next node becomes the stub
+      T *ptr = next->getValue();
+      func(*ptr);
+      ptr->~T();
+
+      m_front = next;
+      delete stub;
+      return true;
+    }
+
+    /**
+     * @brief Put an element in the queue (producer side).
+     *
+     * @param value the element
+     */
+    void push(const T& value) {
+      emplace(value);
+    }
+
+    /**
+     * @brief Put an element in the queue (producer side).
+     *
+     * @param value the element
+     */
+    void push(T&& value) {
+      emplace(std::move(value));
+    }
+
+    /**
+     * @brief Construct an element in the queue (producer side).
+     *
+     * @param args the arguments of the constructor of the element
+     */
+    template<typename ... Args>
+    void emplace(Args&&... args) {
+      Node *node = new Node;
+      new (&node->storage) T(std::forward<Args>(args)...);
+
+      Node *prev = m_back.exchange(node, std::memory_order_acq_rel);
+      prev->next.store(node, std::memory_order_release);
+    }
+
+  private:
+    struct Node {
+      Node()
+      : next(nullptr)
+      {
+      }
+
+      T *getValue() {
+        return reinterpret_cast<T *>(&storage);
+      }
+
+      std::atomic<Node *> next;
+      typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+    };
+
+  private:
+    // producer side
+    std::atomic<Node *> m_back;
+    // consumer side
+    Node *m_front;
+  };
+
+}
+
+#endif // GAME_MPSC_QUEUE_H
@@ -22,18 +22,36 @@
 #ifndef GAME_QUEUE_H
 #define GAME_QUEUE_H
 
+#include <chrono>
 #include <condition_variable>
 #include <deque>
 #include <mutex>
+#include <utility>
 
 namespace game {
 
   /**
+   * @brief A thread-safe unbounded queue.
+   *
+   * The consumers can poll the queue or wait for an element. A waiting
+   * consumer is blocked until an element is pushed or the queue is closed.
+   *
    * @ingroup base
    */
   template<typename T>
   class Queue {
   public:
+    Queue()
+    : m_closed(false)
+    {
+    }
+
+    /**
+     * @brief Get an element if there is one.
+     *
+     * @param value the element
+     * @returns false if the queue was empty
+     */
     bool poll(T& value) {
       std::unique_lock<std::mutex> lock(m_mutex);
 
@@ -41,14 +59,84 @@ namespace game {
         return false;
       }
 
-      value = m_queue.front();
+      value = std::move(m_queue.front());
       m_queue.pop_front();
       return true;
     }
 
-    void push(const T& value) {
+    /**
+     * @brief Wait for an element.
+     *
+     * @param value the element
+     * @returns false if the queue is closed and empty
+     */
+    bool waitPop(T& value) {
       std::unique_lock<std::mutex> lock(m_mutex);
-      m_queue.push_back(value);
+
+      m_available.wait(lock, [this]() {
+        return m_closed || !m_queue.empty();
+      });
+
+      if (m_queue.empty()) {
+        return false;
+      }
+
+      value = std::move(m_queue.front());
+      m_queue.pop_front();
+      return true;
+    }
+
+    /**
+     * @brief Wait for an element, with a timeout.
+     *
+     * @param value the element
+     * @param timeout the maximum duration to wait
+     * @returns false if the timeout expired, or if the queue is closed and
+     * empty
+     */
+    template<typename Rep, typename Period>
+    bool waitPopFor(T& value, const std::chrono::duration<Rep, Period>& timeout) {
+      std::unique_lock<std::mutex> lock(m_mutex);
+
+      m_available.wait_for(lock, timeout, [this]() {
+        return m_closed || !m_queue.empty();
+      });
+
+      if (m_queue.empty()) {
+        return false;
+      }
+
+      value = std::move(m_queue.front());
+      m_queue.pop_front();
+      return true;
+    }
+
+    void push(const T& value) {
+      {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_queue.push_back(value);
+      }
+
+      m_available.notify_one();
+    }
+
+    void push(T&& value) {
+      {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_queue.push_back(std::move(value));
+      }
+
+      m_available.notify_one();
+    }
+
+    template<typename ... Args>
+    void emplace(Args&&... args) {
+      {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_queue.emplace_back(std::forward<Args>(args)...);
+      }
+
+      m_available.notify_one();
     }
 
     void clear() {
@@ -56,9 +144,32 @@ namespace game {
       m_queue.clear();
     }
 
+    /**
+     * @brief Close the queue.
+     *
+     * All the waiting consumers are woken up. The remaining elements can
+     * still be popped, then waitPop() and waitPopFor() return false
+     * immediately. This is meant for the shutdown of the consumers.
+     */
+    void close() {
+      {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_closed = true;
+      }
+
+      m_available.notify_all();
+    }
+
+    bool isClosed() {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      return m_closed;
+    }
+
   private:
     std::mutex m_mutex;
+    std::condition_variable m_available;
     std::deque<T> m_queue;
+    bool m_closed;
   };
 
 }
@@ -21,14 +21,20 @@
  */
 #include "ResourceManager.h"
 
+#include <algorithm>
+
 #include <boost/filesystem.hpp>
 
+#include <SFML/Graphics/Image.hpp>
+
+#include "Log.h"
+
 namespace fs = boost::filesystem;
 
 namespace game {
 
   template<typename T>
-  T *ResourceManager::ResourceCache<T>::findResource(const boost::filesystem::path& key) {
+  typename ResourceManager::ResourceCache<T>::Entry *ResourceManager::ResourceCache<T>::findEntry(const boost::filesystem::path& key) {
     auto it = m_cache.find(key);
 
     if (it != m_cache.end()) {
@@ -38,6 +44,14 @@ namespace game {
     return nullptr;
   }
 
+  template<typename T>
+  typename ResourceManager::ResourceCache<T>::Entry *ResourceManager::ResourceCache<T>::addEntry(const boost::filesystem::path& key) {
+    auto inserted = m_cache.emplace(key, std::unique_ptr<Entry>(new Entry));
+    assert(inserted.second);
+
+    return inserted.first->second.get();
+  }
+
   template<typename T>
   T *ResourceManager::ResourceCache<T>::loadResource(const boost::filesystem::path& key, const boost::filesystem::path& path) {
     std::unique_ptr<T> obj(new T);
@@ -45,10 +59,101 @@ namespace game {
     bool loaded = obj->loadFromFile(path.string());
     assert(loaded);
 
-    auto inserted = m_cache.emplace(key, std::move(obj));
-    assert(inserted.second);
+    return addResource(key, std::move(obj));
+  }
 
-    return inserted.first->second.get();
+  template<typename T>
+  T *ResourceManager::ResourceCache<T>::loadResource(const boost::filesystem::path& key, const char *data, std::size_t size) {
+    std::unique_ptr<T> obj(new T);
+
+    bool loaded = obj->loadFromMemory(data, size);
+    assert(loaded);
+
+    return addResource(key, std::move(obj));
+  }
+
+  template<typename T>
+  T *ResourceManager::ResourceCache<T>::addResource(const boost::filesystem::path& key, std::unique_ptr<T> obj) {
+    Entry *entry = addEntry(key);
+    entry->resource = std::move(obj);
+    entry->ready = true;
+
+    return entry->resource.get();
+  }
+
+  // the upload of a decoded resource, only textures need one
+
+  template<typename T>
+  static std::unique_ptr<T> upload(std::unique_ptr<T> resource) {
+    return resource;
+  }
+
+  static std::unique_ptr<sf::Texture> upload(std::unique_ptr<sf::Image> image) {
+    std::unique_ptr<sf::Texture> texture(new sf::Texture);
+
+    if (!texture->loadFromImage(*image)) {
+      return nullptr;
+    }
+
+    return texture;
+  }
+
+  template<typename T, typename D>
+  struct ResourceManager::Load : public ResourceManager::PendingLoad {
+    typedef typename ResourceHandle<T>::Entry Entry;
+
+    Load(Entry *entry, std::string path, const char *data = nullptr, std::size_t size = 0)
+    : entry(entry)
+    , path(std::move(path))
+    , data(data)
+    , size(size)
+    , loaded(false)
+    {
+    }
+
+    virtual void decode() override {
+      decoded.reset(new D);
+
+      // the data of an archived asset are mapped in memory
+      if (data != nullptr) {
+        loaded = decoded->loadFromMemory(data, size);
+      } else {
+        loaded = decoded->loadFromFile(path);
+      }
+    }
+
+    virtual void finish() override {
+      if (loaded) {
+        entry->resource = upload(std::move(decoded));
+      }
+
+      if (!entry->resource) {
+        Log::error(Log::RESOURCES, "Could not load the resource: %s\n", path.c_str());
+      }
+
+      entry->ready = true;
+      entry->decoding = nullptr;
+    }
+
+    Entry *entry;
+    std::string path;
+    const char *data;
+    std::size_t size;
+    std::unique_ptr<D> decoded;
+    bool loaded;
+  };
+
+  ResourceManager::ResourceManager()
+  : m_jobs(nullptr)
+  {
+  }
+
+  ResourceManager::~ResourceManager() {
+    // the workers must not decode in a destroyed load
+    for (auto& load : m_pending) {
+      assert(m_jobs != nullptr);
+      m_jobs->wait(load->counter);
+    }
   }
 
   sf::Font *ResourceManager::getFont(const boost::filesystem::path& path) {
@@ -63,12 +168,50 @@ namespace game {
     return getResource(path, m_textures);
   }
 
+  ResourceHandle<sf::Font> ResourceManager::requestFont(const boost::filesystem::path& path) {
+    return requestResource<sf::Font, sf::Font>(path, m_fonts);
+  }
+
+  ResourceHandle<sf::SoundBuffer> ResourceManager::requestSoundBuffer(const boost::filesystem::path& path) {
+    return requestResource<sf::SoundBuffer, sf::SoundBuffer>(path, m_sounds);
+  }
+
+  ResourceHandle<sf::Texture> ResourceManager::requestTexture(const boost::filesystem::path& path) {
+    return requestResource<sf::Texture, sf::Image>(path, m_textures);
+  }
+
+  void ResourceManager::update() {
+    if (m_pending.empty()) {
+      return;
+    }
+
+    m_pending.erase(std::remove_if(m_pending.begin(), m_pending.end(), [](const std::unique_ptr<PendingLoad>& load) {
+      if (!load->counter.isDone()) {
+        return false;
+      }
+
+      load->finish();
+      return true;
+    }), m_pending.end());
+  }
+
   template<typename T>
   T *ResourceManager::getResource(const boost::filesystem::path& path, ResourceCache<T>& cache) {
-    auto res = cache.findResource(path);
+    auto entry = cache.findEntry(path);
 
-    if (res != nullptr) {
-      return res;
+    if (entry != nullptr) {
+      if (!entry->ready) {
+        waitDecoding(*entry->decoding);
+      }
+
+      return entry->resource.get();
+    }
+
+    std::size_t size;
+    const char *data = findArchivedAsset(path, size);
+
+    if (data != nullptr) {
+      return cache.loadResource(path, data, size);
     }
 
     auto absolute_path = getAbsolutePath(path);
@@ -80,4 +223,55 @@ namespace game {
     return cache.loadResource(path, absolute_path);
   }
 
+  template<typename T, typename D>
+  ResourceHandle<T> ResourceManager::requestResource(const boost::filesystem::path& path, ResourceCache<T>& cache) {
+    auto entry = cache.findEntry(path);
+
+    if (entry != nullptr) {
+      return ResourceHandle<T>(this, entry);
+    }
+
+    entry = cache.addEntry(path);
+    std::unique_ptr<Load<T, D>> load;
+
+    std::size_t size;
+    const char *data = findArchivedAsset(path, size);
+
+    if (data != nullptr) {
+      load.reset(new Load<T, D>(entry, path.string(), data, size));
+    } else {
+      auto absolute_path = getAbsolutePath(path);
+
+      // the resource can not be found, the request fails immediately
+      if (absolute_path.empty()) {
+        entry->ready = true;
+        return ResourceHandle<T>(this, entry);
+      }
+
+      load.reset(new Load<T, D>(entry, absolute_path.string()));
+    }
+
+    if (m_jobs == nullptr) {
+      load->decode();
+      load->finish();
+      return ResourceHandle<T>(this, entry);
+    }
+
+    Load<T, D> *pending = load.get();
+    entry->decoding = &pending->counter;
+    m_pending.push_back(std::move(load));
+
+    m_jobs->submit([pending]() {
+      pending->decode();
+    }, &pending->counter);
+
+    return ResourceHandle<T>(this, entry);
+  }
+
+  void ResourceManager::waitDecoding(JobCounter& decoding) {
+    assert(m_jobs != nullptr);
+    m_jobs->wait(decoding);
+    update();
+  }
+
 }
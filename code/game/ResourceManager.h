@@ -22,47 +22,227 @@
 #ifndef GAME_RESOURCE_MANAGER_H
 #define GAME_RESOURCE_MANAGER_H
 
+#include <cassert>
 #include <string>
 #include <map>
 #include <memory>
+#include <vector>
 
 #include <SFML/Graphics/Texture.hpp>
 #include <SFML/Graphics/Font.hpp>
 #include <SFML/Audio/SoundBuffer.hpp>
 
 #include "AssetManager.h"
+#include "JobSystem.h"
 
 namespace game {
 
+  class ResourceManager;
+
+  /**
+   * @brief A handle to a requested resource.
+   *
+   * The handle is returned immediately by a request, and is ready when the
+   * resource has been loaded, or has failed to load. The handle stays valid
+   * as long as the resource manager.
+   *
+   * @sa ResourceManager::requestTexture
+   * @ingroup graphics
+   */
+  template<typename T>
+  class ResourceHandle {
+  public:
+    ResourceHandle()
+    : m_manager(nullptr)
+    , m_entry(nullptr)
+    {
+    }
+
+    bool isValid() const {
+      return m_entry != nullptr;
+    }
+
+    /**
+     * @brief Tell whether the resource has been loaded (or has failed).
+     */
+    bool isReady() const {
+      return m_entry != nullptr && m_entry->ready;
+    }
+
+    /**
+     * @brief Get the resource.
+     *
+     * @returns the resource, or @c nullptr if it is not ready or if it has
+     * failed to load
+     */
+    T *get() const {
+      return isReady() ? m_entry->resource.get() : nullptr;
+    }
+
+    /**
+     * @brief Wait for the resource.
+     *
+     * This function must be called from the thread of the resource manager.
+     * It executes jobs while the resource is decoded.
+     *
+     * @returns the resource, or @c nullptr if it has failed to load
+     */
+    T *wait() const;
+
+  private:
+    friend class ResourceManager;
+
+    struct Entry {
+      Entry()
+      : ready(false)
+      , decoding(nullptr)
+      {
+      }
+
+      std::unique_ptr<T> resource;
+      bool ready;
+      JobCounter *decoding; // the counter of the decoding job, nullptr when ready
+    };
+
+    ResourceHandle(ResourceManager *manager, Entry *entry)
+    : m_manager(manager)
+    , m_entry(entry)
+    {
+    }
+
+    ResourceManager *m_manager;
+    Entry *m_entry;
+  };
+
   /**
    * @ingroup graphics
    */
   class ResourceManager : public AssetManager {
   public:
+    ResourceManager();
+
+    /**
+     * @brief Wait for the pending requests.
+     */
+    ~ResourceManager();
+
+    /**
+     * @brief Set a job system for the requests.
+     *
+     * When a job system is set, the requested resources are decoded by the
+     * workers. Otherwise, they are loaded when they are requested. The job
+     * system must outlive the manager.
+     *
+     * @param jobs the job system or @c nullptr to load synchronously
+     * @sa requestTexture()
+     */
+    void setJobSystem(JobSystem *jobs) {
+      m_jobs = jobs;
+    }
+
     sf::Font *getFont(const boost::filesystem::path& path);
     sf::SoundBuffer *getSoundBuffer(const boost::filesystem::path& path);
     sf::Texture *getTexture(const boost::filesystem::path& path);
 
+    /**
+     * @name Asynchronous requests
+     * @{
+     */
+    /**
+     * @brief Request a font.
+     *
+     * The font is loaded by a worker.
+     */
+    ResourceHandle<sf::Font> requestFont(const boost::filesystem::path& path);
+
+    /**
+     * @brief Request a sound buffer.
+     *
+     * The sound buffer is loaded by a worker.
+     */
+    ResourceHandle<sf::SoundBuffer> requestSoundBuffer(const boost::filesystem::path& path);
+
+    /**
+     * @brief Request a texture.
+     *
+     * The image is decoded by a worker, and is uploaded to the GPU by
+     * update(), on the thread of the manager.
+     */
+    ResourceHandle<sf::Texture> requestTexture(const boost::filesystem::path& path);
+
+    /**
+     * @brief Finish the requests that have been decoded.
+     *
+     * This function must be called regularly (e.g. once per frame) from the
+     * thread of the manager, that must be the render thread.
+     */
+    void update();
+    /** @} */
+
   private:
+    template<typename T>
+    friend class ResourceHandle;
+
+    // a pending load, whatever the type of resource
+    struct PendingLoad {
+      virtual ~PendingLoad() {
+      }
+
+      // called by a worker
+      virtual void decode() = 0;
+      // called by the thread of the manager
+      virtual void finish() = 0;
+
+      JobCounter counter;
+    };
+
+    template<typename T, typename D>
+    struct Load;
+
     template<typename T>
     class ResourceCache {
     public:
-      T *findResource(const boost::filesystem::path& key);
+      typedef typename ResourceHandle<T>::Entry Entry;
+
+      Entry *findEntry(const boost::filesystem::path& key);
+      Entry *addEntry(const boost::filesystem::path& key);
       T *loadResource(const boost::filesystem::path& key, const boost::filesystem::path& path);
+      T *loadResource(const boost::filesystem::path& key, const char *data, std::size_t size);
     private:
-      std::map<boost::filesystem::path, std::unique_ptr<T>> m_cache;
+      T *addResource(const boost::filesystem::path& key, std::unique_ptr<T> obj);
+
+      std::map<boost::filesystem::path, std::unique_ptr<Entry>> m_cache;
     };
 
   private:
+    JobSystem *m_jobs;
     ResourceCache<sf::Font> m_fonts;
     ResourceCache<sf::SoundBuffer> m_sounds;
     ResourceCache<sf::Texture> m_textures;
+    std::vector<std::unique_ptr<PendingLoad>> m_pending;
 
   private:
     template<typename T>
     T *getResource(const boost::filesystem::path& path, ResourceCache<T>& cache);
+
+    template<typename T, typename D>
+    ResourceHandle<T> requestResource(const boost::filesystem::path& path, ResourceCache<T>& cache);
+
+    void waitDecoding(JobCounter& decoding);
   };
 
+  template<typename T>
+  T *ResourceHandle<T>::wait() const {
+    assert(isValid());
+
+    if (!m_entry->ready) {
+      m_manager->waitDecoding(*m_entry->decoding);
+    }
+
+    assert(m_entry->ready);
+    return m_entry->resource.get();
+  }
+
 }
 
 #endif // GAME_RESOURCE_MANAGER_H
@@ -0,0 +1,279 @@
+/*
+ * Copyright (c) 2014-2015, Julien Bernard
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#include "SpatialGrid.h"
+
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+#include <utility>
+
+namespace game {
+
+  namespace {
+
+    float squaredDistance(const Vector2f& lhs, const Vector2f& rhs) {
+      Vector2f d = lhs - rhs;
+      return dotProduct(d, d);
+    }
+
+  }
+
+  SpatialGrid::SpatialGrid(float cellSize)
+  : m_cell_size(cellSize)
+  , m_count(0)
+  {
+    assert(cellSize > 0.0f);
+  }
+
+  void SpatialGrid::addEntity(EntityHandle h, const Vector2f& position) {
+    if (h.index >= m_records.size()) {
+      m_records.resize(h.index + 1, { EntityHandle(), { 0.0f, 0.0f }, 0, 0, false });
+    }
+
+    Record& record = m_records[h.index];
+    assert(!record.present);
+
+    record.handle = h;
+    record.position = position;
+    record.present = true;
+    insertInCell(h.index, computeKey(computeCell(position)));
+    ++m_count;
+  }
+
+  void SpatialGrid::moveEntity(EntityHandle h, const Vector2f& position) {
+    assert(h.index < m_records.size());
+    Record& record = m_records[h.index];
+    assert(record.present && record.handle == h);
+
+    record.position = position;
+    uint64_t key = computeKey(computeCell(position));
+
+    if (key != record.cell) {
+      removeFromCell(h.index);
+      insertInCell(h.index, key);
+    }
+  }
+
+  void SpatialGrid::removeEntity(EntityHandle h) {
+    if (h.index >= m_records.size()) {
+      return;
+    }
+
+    Record& record = m_records[h.index];
+
+    if (!record.present || record.handle != h) {
+      return;
+    }
+
+    removeFromCell(h.index);
+    record.present = false;
+    --m_count;
+  }
+
+  void SpatialGrid::clear() {
+    m_records.clear();
+    m_buckets.clear();
+    m_count = 0;
+  }
+
+  void SpatialGrid::queryRadius(const Vector2f& center, float radius, std::vector<EntityHandle>& result) const {
+    Cell min = computeCell({ center.x - radius, center.y - radius });
+    Cell max = computeCell({ center.x + radius, center.y + radius });
+    float radius2 = radius * radius;
+
+    forEachBucket(min, max, [&](const Bucket& bucket) {
+      for (auto index : bucket) {
+        const Record& record = m_records[index];
+
+        if (squaredDistance(record.position, center) <= radius2) {
+          result.push_back(record.handle);
+        }
+      }
+    });
+  }
+
+  void SpatialGrid::queryRect(const Vector2f& min, const Vector2f& max, std::vector<EntityHandle>& result) const {
+    forEachBucket(computeCell(min), computeCell(max), [&](const Bucket& bucket) {
+      for (auto index : bucket) {
+        const Record& record = m_records[index];
+        const Vector2f& pos = record.position;
+
+        if (min.x <= pos.x && pos.x <= max.x && min.y <= pos.y && pos.y <= max.y) {
+          result.push_back(record.handle);
+        }
+      }
+    });
+  }
+
+  void SpatialGrid::queryNearest(const Vector2f& center, std::size_t k, std::vector<EntityHandle>& result) const {
+    if (k == 0 || m_count == 0) {
+      return;
+    }
+
+    std::vector<std::pair<float, uint32_t>> candidates;
+    std::size_t seen = 0;
+
+    auto collect = [&](const Bucket& bucket) {
+      for (auto index : bucket) {
+        candidates.push_back(std::make_pair(squaredDistance(m_records[index].position, center), index));
+      }
+
+      seen += bucket.size();
+    };
+
+    auto visit = [&](int32_t x, int32_t y) {
+      const Bucket *bucket = findBucket({ x, y });
+
+      if (bucket != nullptr) {
+        collect(*bucket);
+      }
+    };
+
+    Cell c = computeCell(center);
+
+    // visit the rings of cells around the center, nearest first
+    for (int32_t r = 0; seen < m_count; ++r) {
+      if (static_cast<std::size_t>(8 * r) > m_buckets.size()) {
+        // the ring is larger than the grid: scan the remaining buckets
+        for (auto& item : m_buckets) {
+          int32_t x = static_cast<int32_t>(item.first >> 32);
+          int32_t y = static_cast<int32_t>(item.first & 0xFFFFFFFF);
+
+          if (std::max(std::abs(x - c.x), std::abs(y - c.y)) >= r) {
+            collect(item.second);
+          }
+        }
+
+        break;
+      }
+
+      if (r == 0) {
+        visit(c.x, c.y);
+      } else {
+        for (int32_t x = c.x - r; x <= c.x + r; ++x) {
+          visit(x, c.y - r);
+          visit(x, c.y + r);
+        }
+
+        for (int32_t y = c.y - r + 1; y <= c.y + r - 1; ++y) {
+          visit(c.x - r, y);
+          visit(c.x + r, y);
+        }
+      }
+
+      if (candidates.size() >= k) {
+        // the unvisited entities are at least at this distance
+        float limit = r * m_cell_size;
+        std::nth_element(candidates.begin(), candidates.begin() + (k - 1), candidates.end());
+
+        if (candidates[k - 1].first <= limit * limit) {
+          break;
+        }
+      }
+    }
+
+    std::size_t count = std::min(k, candidates.size());
+    std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end());
+
+    for (std::size_t i = 0; i < count; ++i) {
+      result.push_back(m_records[candidates[i].second].handle);
+    }
+  }
+
+  SpatialGrid::Cell SpatialGrid::computeCell(const Vector2f& position) const {
+    return {
+      static_cast<int32_t>(std::floor(position.x / m_cell_size)),
+      static_cast<int32_t>(std::floor(position.y / m_cell_size))
+    };
+  }
+
+  uint64_t SpatialGrid::computeKey(Cell cell) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(cell.x)) << 32) | static_cast<uint32_t>(cell.y);
+  }
+
+  void SpatialGrid::insertInCell(uint32_t index, uint64_t key) {
+    Bucket& bucket = m_buckets[key];
+    Record& record = m_records[index];
+    record.cell = key;
+    record.slot = bucket.size();
+    bucket.push_back(index);
+  }
+
+  void SpatialGrid::removeFromCell(uint32_t index) {
+    Record& record = m_records[index];
+    auto it = m_buckets.find(record.cell);
+    assert(it != m_buckets.end());
+    Bucket& bucket = it->second;
+
+    // move the last record in the hole
+    uint32_t last = bucket.back();
+    bucket[record.slot] = last;
+    m_records[last].slot = record.slot;
+    bucket.pop_back();
+
+    // only the occupied cells are kept, the queries rely on it
+    if (bucket.empty()) {
+      m_buckets.erase(it);
+    }
+  }
+
+  const SpatialGrid::Bucket *SpatialGrid::findBucket(Cell cell) const {
+    auto it = m_buckets.find(computeKey(cell));
+
+    if (it == m_buckets.end()) {
+      return nullptr;
+    }
+
+    return &it->second;
+  }
+
+  template<typename Func>
+  void SpatialGrid::forEachBucket(Cell min, Cell max, Func func) const {
+    uint64_t width = static_cast<int64_t>(max.x) - min.x + 1;
+    uint64_t height = static_cast<int64_t>(max.y) - min.y + 1;
+
+    if (width * height > m_buckets.size()) {
+      // fewer buckets than cells in the area
+      for (auto& item : m_buckets) {
+        int32_t x = static_cast<int32_t>(item.first >> 32);
+        int32_t y = static_cast<int32_t>(item.first & 0xFFFFFFFF);
+
+        if (min.x <= x && x <= max.x && min.y <= y && y <= max.y) {
+          func(item.second);
+        }
+      }
+
+      return;
+    }
+
+    for (int32_t y = min.y; y <= max.y; ++y) {
+      for (int32_t x = min.x; x <= max.x; ++x) {
+        const Bucket *bucket = findBucket({ x, y });
+
+        if (bucket != nullptr) {
+          func(*bucket);
+        }
+      }
+    }
+  }
+
+}
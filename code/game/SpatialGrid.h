@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2014-2015, Julien Bernard
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#ifndef GAME_SPATIAL_GRID_H
+#define GAME_SPATIAL_GRID_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "EntityManager.h"
+#include "Vector.h"
+
+namespace game {
+
+  /**
+   * @brief A uniform spatial hash grid of entities.
+   *
+   * The world is divided in square cells and each entity is stored in the
+   * cell of its position. Only the non-empty cells are allocated. The grid is
+   * updated incrementally: moving an entity inside its cell only updates its
+   * position.
+   *
+   * The cell size should be about the radius of the usual queries.
+   *
+   * @ingroup graphics
+   */
+  class SpatialGrid {
+  public:
+    /**
+     * @brief Create a grid.
+     *
+     * @param cellSize the size of a cell, in world units
+     */
+    explicit SpatialGrid(float cellSize);
+
+    /**
+     * @brief Add an entity.
+     *
+     * @param h the handle of the entity
+     * @param position the position of the entity
+     */
+    void addEntity(EntityHandle h, const Vector2f& position);
+
+    /**
+     * @brief Change the position of an entity.
+     *
+     * @param h the handle of the entity
+     * @param position the new position of the entity
+     */
+    void moveEntity(EntityHandle h, const Vector2f& position);
+
+    /**
+     * @brief Remove an entity.
+     *
+     * @param h the handle of the entity
+     */
+    void removeEntity(EntityHandle h);
+
+    /**
+     * @brief Remove all the entities.
+     */
+    void clear();
+
+    std::size_t getEntityCount() const {
+      return m_count;
+    }
+
+    /**
+     * @brief Find the entities within a distance of a point.
+     *
+     * @param center the center of the query
+     * @param radius the maximum distance to the center
+     * @param result the vector where the entities are appended
+     */
+    void queryRadius(const Vector2f& center, float radius, std::vector<EntityHandle>& result) const;
+
+    /**
+     * @brief Find the entities inside a rectangle.
+     *
+     * @param min the minimum corner of the rectangle
+     * @param max the maximum corner of the rectangle
+     * @param result the vector where the entities are appended
+     */
+    void queryRect(const Vector2f& min, const Vector2f& max, std::vector<EntityHandle>& result) const;
+
+    /**
+     * @brief Find the nearest entities of a point.
+     *
+     * @param center the center of the query
+     * @param k the maximum number of entities
+     * @param result the vector where the entities are appended, nearest first
+     */
+    void queryNearest(const Vector2f& center, std::size_t k, std::vector<EntityHandle>& result) const;
+
+  private:
+    struct Record {
+      EntityHandle handle;
+      Vector2f position;
+      uint64_t cell;
+      uint32_t slot; // in the cell
+      bool present;
+    };
+
+    struct Cell {
+      int32_t x;
+      int32_t y;
+    };
+
+    typedef std::vector<uint32_t> Bucket; // of record indices
+
+    Cell computeCell(const Vector2f& position) const;
+    static uint64_t computeKey(Cell cell);
+
+    void insertInCell(uint32_t index, uint64_t key);
+    void removeFromCell(uint32_t index);
+
+    const Bucket *findBucket(Cell cell) const;
+
+    template<typename Func>
+    void forEachBucket(Cell min, Cell max, Func func) const;
+
+  private:
+    float m_cell_size;
+    std::size_t m_count;
+    std::vector<Record> m_records; // indexed by the handle index
+    std::unordered_map<uint64_t, Bucket> m_buckets;
+  };
+
+}
+
+#endif // GAME_SPATIAL_GRID_H
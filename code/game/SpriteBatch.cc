@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2014-2015, Julien Bernard
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#include "SpriteBatch.h"
+
+#include <cassert>
+
+namespace game {
+
+  SpriteBatch::SpriteBatch(sf::RenderWindow& window)
+  : m_window(window)
+  , m_active(0)
+  , m_draw_calls(0)
+  {
+  }
+
+  void SpriteBatch::draw(const sf::Texture& texture, const sf::IntRect& rect, const sf::Transform& transform, const sf::Color& color, const sf::BlendMode& blend) {
+    sf::Vector2f size(static_cast<float>(rect.width), static_cast<float>(rect.height));
+    addQuad(&texture, rect, size, transform, color, blend);
+  }
+
+  void SpriteBatch::draw(const sf::Sprite& sprite, const sf::BlendMode& blend) {
+    assert(sprite.getTexture() != nullptr);
+    draw(*sprite.getTexture(), sprite.getTextureRect(), sprite.getTransform(), sprite.getColor(), blend);
+  }
+
+  void SpriteBatch::draw(const sf::RectangleShape& shape, const sf::BlendMode& blend) {
+    addQuad(shape.getTexture(), shape.getTextureRect(), shape.getSize(), shape.getTransform(), shape.getFillColor(), blend);
+  }
+
+  void SpriteBatch::addQuad(const sf::Texture *texture, const sf::IntRect& rect, const sf::Vector2f& size, const sf::Transform& transform, const sf::Color& color, const sf::BlendMode& blend) {
+    Group& group = getGroup(texture, blend);
+
+    float width = size.x;
+    float height = size.y;
+
+    float left = static_cast<float>(rect.left);
+    float top = static_cast<float>(rect.top);
+    float right = left + static_cast<float>(rect.width);
+    float bottom = top + static_cast<float>(rect.height);
+
+    group.vertices.append(sf::Vertex(transform.transformPoint(0.0f, 0.0f), color, sf::Vector2f(left, top)));
+    group.vertices.append(sf::Vertex(transform.transformPoint(width, 0.0f), color, sf::Vector2f(right, top)));
+    group.vertices.append(sf::Vertex(transform.transformPoint(width, height), color, sf::Vector2f(right, bottom)));
+    group.vertices.append(sf::Vertex(transform.transformPoint(0.0f, height), color, sf::Vector2f(left, bottom)));
+  }
+
+  void SpriteBatch::flush() {
+    for (std::size_t i = 0; i < m_active; ++i) {
+      Group& group = m_groups[i];
+
+      sf::RenderStates states(group.texture);
+      states.blendMode = group.blend;
+      m_window.draw(group.vertices, states);
+      ++m_draw_calls;
+
+      group.vertices.clear();
+    }
+
+    m_active = 0;
+  }
+
+  SpriteBatch::Group& SpriteBatch::getGroup(const sf::Texture *texture, const sf::BlendMode& blend) {
+    // there are only a few textures, a linear search is enough
+    for (std::size_t i = 0; i < m_active; ++i) {
+      Group& group = m_groups[i];
+
+      if (group.texture == texture && group.blend == blend) {
+        return group;
+      }
+    }
+
+    if (m_active == m_groups.size()) {
+      m_groups.push_back({ texture, blend, sf::VertexArray(sf::Quads) });
+    }
+
+    Group& group = m_groups[m_active++];
+    group.texture = texture;
+    group.blend = blend;
+    return group;
+  }
+
+}
@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2014-2015, Julien Bernard
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#ifndef GAME_SPRITE_BATCH_H
+#define GAME_SPRITE_BATCH_H
+
+#include <cstddef>
+#include <vector>
+
+#include <SFML/Graphics.hpp>
+
+namespace game {
+
+  /**
+   * @brief A collector of textured quads, drawn by texture.
+   *
+   * The quads are grouped by texture and blend mode. At each flush, every
+   * group is drawn with a single draw call, in the order of the first quad
+   * of each group. So, between two flushes, the quads of different groups
+   * may be drawn in a different order than they were added.
+   *
+   * @ingroup graphics
+   */
+  class SpriteBatch {
+  public:
+    /**
+     * @brief Create a batch for a window.
+     *
+     * @param window the window where the quads are drawn
+     */
+    explicit SpriteBatch(sf::RenderWindow& window);
+
+    sf::RenderWindow& getWindow() {
+      return m_window;
+    }
+
+    /**
+     * @brief Add a textured quad.
+     *
+     * @param texture the texture of the quad
+     * @param rect the rectangle of the texture to draw
+     * @param transform the transform from the local rectangle to the world
+     * @param color the color of the quad
+     * @param blend the blend mode of the quad
+     */
+    void draw(const sf::Texture& texture, const sf::IntRect& rect, const sf::Transform& transform, const sf::Color& color = sf::Color::White, const sf::BlendMode& blend = sf::BlendAlpha);
+
+    /**
+     * @brief Add a sprite.
+     *
+     * @param sprite the sprite, it must have a texture
+     * @param blend the blend mode of the sprite
+     */
+    void draw(const sf::Sprite& sprite, const sf::BlendMode& blend = sf::BlendAlpha);
+
+    /**
+     * @brief Add a rectangle shape.
+     *
+     * The shape may have no texture: all the untextured quads of a blend
+     * mode are drawn together. The outline of the shape is not drawn.
+     *
+     * @param shape the shape
+     * @param blend the blend mode of the shape
+     */
+    void draw(const sf::RectangleShape& shape, const sf::BlendMode& blend = sf::BlendAlpha);
+
+    /**
+     * @brief Draw all the quads and empty the batch.
+     */
+    void flush();
+
+    /**
+     * @brief Get the number of draw calls since the last reset.
+     */
+    std::size_t getDrawCallCount() const {
+      return m_draw_calls;
+    }
+
+    void resetDrawCallCount() {
+      m_draw_calls = 0;
+    }
+
+  private:
+    struct Group {
+      const sf::Texture *texture; // nullptr for the untextured quads
+      sf::BlendMode blend;
+      sf::VertexArray vertices;
+    };
+
+    void addQuad(const sf::Texture *texture, const sf::IntRect& rect, const sf::Vector2f& size, const sf::Transform& transform, const sf::Color& color, const sf::BlendMode& blend);
+    Group& getGroup(const sf::Texture *texture, const sf::BlendMode& blend);
+
+  private:
+    sf::RenderWindow& m_window;
+    // the groups are kept between flushes to reuse their memory
+    std::vector<Group> m_groups;
+    std::size_t m_active;
+    std::size_t m_draw_calls;
+  };
+
+}
+
+#endif // GAME_SPRITE_BATCH_H
@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2014-2015, Julien Bernard
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#ifndef GAME_SPSC_QUEUE_H
+#define GAME_SPSC_QUEUE_H
+
+#include <cassert>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace game {
+
+  /**
+   * @brief A bounded single-producer/single-consumer queue.
+   *
+   * This is a lock-free alternative to Queue when exactly one thread pushes
+   * and exactly one thread polls. Both operations are wait-free and do not
+   * allocate: the elements are stored in a ring buffer allocated at
+   * construction. The head and the tail are kept on separate cache lines, and
+   * each side caches the last index it read from the other side.
+   *
+   * @sa Queue
+   * @ingroup base
+   */
+  template<typename T>
+  class SpscQueue {
+  public:
+    /**
+     * @brief Create a queue.
+     *
+     * @param capacity the minimum capacity of the queue, rounded up to a
+     * power of two
+     */
+    explicit SpscQueue(std::size_t capacity)
+    : m_capacity(roundCapacity(capacity))
+    , m_mask(m_capacity - 1)
+    , m_buffer(new Storage[m_capacity])
+    , m_head(0)
+    , m_tail_cache(0)
+    , m_tail(0)
+    , m_head_cache(0)
+    {
+    }
+
+    ~SpscQueue() {
+      clear();
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    std::size_t getCapacity() const {
+      return m_capacity;
+    }
+
+    /**
+     * @brief Get an element from the queue (consumer side).
+     *
+     * @param value the element
+     * @returns false if the queue was empty
+     */
+    bool poll(T& value) {
+      std::size_t head = m_head.load(std::memory_order_relaxed);
+
+      if (head == m_tail_cache) {
+        m_tail_cache = m_tail.load(std::memory_order_acquire);
+
+        if (head == m_tail_cache) {
+          return false;
+        }
+      }
+
+      T *ptr = reinterpret_cast<T *>(&m_buffer[head & m_mask]);
+      value = std::move(*ptr);
+      ptr->~T();
+
+      m_head.store(head + 1, std::memory_order_release);
+      return true;
+    }
+
+    /**
+     * @brief Put an element in the queue (producer side).
+     *
+     * @param value the element
+     * @returns false if the queue was full
+     */
+    bool push(const T& value) {
+      return emplace(value);
+    }
+
+    /**
+     * @brief Put an element in the queue (producer side).
+     *
+     * @param value the element
+     * @returns false if the queue was full
+     */
+    bool push(T&& value) {
+      return emplace(std::move(value));
+    }
+
+    /**
+     * @brief Construct an element in the queue (producer side).
+     *
+     * @param args the arguments of the constructor of the element
+     * @returns false if the queue was full
+     */
+    template<typename ... Args>
+    bool emplace(Args&&... args) {
+      std::size_t tail = m_tail.load(std::memory_order_relaxed);
+
+      if (tail - m_head_cache == m_capacity) {
+        m_head_cache = m_head.load(std::memory_order_acquire);
+
+        if (tail - m_head_cache == m_capacity) {
+          return false;
+        }
+      }
+
+      new (&m_buffer[tail & m_mask]) T(std::forward<Args>(args)...);
+
+      m_tail.store(tail + 1, std::memory_order_release);
+      return true;
+    }
+
+    /**
+     * @brief Remove all the elements (consumer side).
+     */
+    void clear() {
+      std::size_t head = m_head.load(std::memory_order_relaxed);
+      std::size_t tail = m_tail.load(std::memory_order_acquire);
+
+      for (; head != tail; ++head) {
+        reinterpret_cast<T *>(&m_buffer[head & m_mask])->~T();
+      }
+
+      m_head.store(head, std::memory_order_release);
+    }
+
+  private:
+    static constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+    typedef typename std::aligned_storage<sizeof(T), alignof(T)>::type Storage;
+
+    static std::size_t roundCapacity(std::size_t capacity) {
+      assert(capacity > 0);
+      std::size_t rounded = 1;
+
+      while (rounded < capacity) {
+        rounded <<= 1;
+      }
+
+      return rounded;
+    }
+
+  private:
+    const std::size_t m_capacity;
+    const std::size_t m_mask;
+    std::unique_ptr<Storage[]> m_buffer;
+
+    char m_padding0[CACHE_LINE_SIZE];
+
+    // consumer side
+    std::atomic<std::size_t> m_head;
+    std::size_t m_tail_cache;
+
+    char m_padding1[CACHE_LINE_SIZE];
+
+    // producer side
+    std::atomic<std::size_t> m_tail;
+    std::size_t m_head_cache;
+
+    char m_padding2[CACHE_LINE_SIZE];
+  };
+
+}
+
+#endif // GAME_SPSC_QUEUE_H
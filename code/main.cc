@@ -21,13 +21,18 @@
  */
 #include <cassert>
 #include <cstdio>
+#include <cstring>
 
 #include "game/Action.h"
 #include "game/Camera.h"
-#include "game/Clock.h"
 #include "game/EntityManager.h"
+#include "game/EventManager.h"
+#include "game/EventRecorder.h"
+#include "game/EventReplayer.h"
+#include "game/GameLoop.h"
 #include "game/Log.h"
 #include "game/ResourceManager.h"
+#include "game/SpriteBatch.h"
 #include "game/WindowGeometry.h"
 #include "game/WindowSettings.h"
 
@@ -36,15 +41,37 @@
 static constexpr float AREA_WIDTH = 100.0f;
 static constexpr float AREA_HEIGHT = 70.0f;
 
+struct WindowResizedEvent : public game::Event {
+  static const game::EventType type = "WindowResizedEvent"_type;
+
+  WindowResizedEvent(unsigned width, unsigned height)
+  : width(width)
+  , height(height)
+  {
+  }
+
+  unsigned width;
+  unsigned height;
+};
+
 class Background : public game::Entity {
 public:
 
   virtual void render(sf::RenderWindow& window) override {
+    window.draw(getShape());
+  }
+
+  virtual void renderBatched(game::SpriteBatch& batch) override {
+    batch.draw(getShape());
+  }
+
+private:
+  sf::RectangleShape getShape() const {
     sf::RectangleShape shape({ AREA_WIDTH, AREA_HEIGHT });
     shape.setOrigin(AREA_WIDTH / 2, AREA_HEIGHT / 2);
     shape.setPosition(0.0f, 0.0f);
     shape.setFillColor(sf::Color(0xCC, 0xCC, 0xCC));
-    window.draw(shape);
+    return shape;
   }
 
 };
@@ -58,12 +85,21 @@ public:
   }
 
   virtual void render(sf::RenderWindow& window) override {
+    window.draw(getShape());
+  }
+
+  virtual void renderBatched(game::SpriteBatch& batch) override {
+    batch.draw(getShape());
+  }
+
+private:
+  sf::RectangleShape getShape() const {
     sf::Vector2f pos = m_geometry.getCornerPosition({ -74.0f, -74.0f });
 
     sf::RectangleShape shape({ 64, 64 });
     shape.setPosition(pos);
     shape.setFillColor(sf::Color(0xCC, 0x00, 0x00));
-    window.draw(shape);
+    return shape;
   }
 
 private:
@@ -89,6 +125,13 @@ int main(int argc, char *argv[]) {
   game::ResourceManager resources;
   resources.addSearchDir(GAME_DATADIR);
 
+  // the archive of the data (see game_pack) avoids opening every file
+  boost::filesystem::path archive = boost::filesystem::path(GAME_DATADIR) / "data.pack";
+
+  if (boost::filesystem::is_regular_file(archive)) {
+    resources.addArchive(archive);
+  }
+
   // add cameras
   game::CameraManager cameras;
 
@@ -98,6 +141,21 @@ int main(int argc, char *argv[]) {
   game::HeadsUpCamera hudCamera(window);
   cameras.addCamera(hudCamera);
 
+  // add events
+  game::EventManager events;
+
+  // a resize drag sends many events, only the last one is useful
+  events.coalesceEvents<WindowResizedEvent>();
+  events.registerTypedHandler<WindowResizedEvent>([&cameras, &geometry](const WindowResizedEvent& resized) {
+    sf::Event event;
+    event.type = sf::Event::Resized;
+    event.size.width = resized.width;
+    event.size.height = resized.height;
+    cameras.update(event);
+    geometry.update(event);
+    return game::EventStatus::KEEP;
+  });
+
   // add actions
   game::ActionManager actions;
 
@@ -110,6 +168,20 @@ int main(int argc, char *argv[]) {
   fullscreenAction.addKeyControl(sf::Keyboard::F);
   actions.addAction(fullscreenAction);
 
+  // record or replay a session: --record <trace> or --replay <trace>
+  game::EventRecorder recorder;
+  game::EventReplayer replayer;
+
+  if (argc == 3 && std::strcmp(argv[1], "--record") == 0 && recorder.open(argv[2])) {
+    actions.setRecorder(&recorder);
+    events.setRecorder(&recorder);
+  }
+
+  if (argc == 3 && std::strcmp(argv[1], "--replay") == 0 && replayer.loadFromFile(argv[2])) {
+    actions.replayFrom(replayer);
+    replayer.replayQueuedTo<WindowResizedEvent>(events);
+  }
+
   // add entities
 
   game::EntityManager mainEntities;
@@ -121,7 +193,13 @@ int main(int argc, char *argv[]) {
   hudEntities.addEntity(map);
 
   // main loop
-  game::Clock clock;
+  static constexpr float TIMESTEP = 1 / 60.0f;
+
+  game::GameLoop loop(TIMESTEP);
+  loop.addEntities(mainEntities);
+  loop.addEntities(hudEntities);
+
+  game::SpriteBatch batch(window);
 
   while (window.isOpen()) {
     // input
@@ -129,10 +207,17 @@ int main(int argc, char *argv[]) {
 
     while (window.pollEvent(event)) {
       actions.update(event);
-      cameras.update(event);
-      geometry.update(event);
+
+      if (event.type == sf::Event::Resized) {
+        events.postEvent(WindowResizedEvent(event.size.width, event.size.height));
+      } else {
+        cameras.update(event);
+        geometry.update(event);
+      }
     }
 
+    replayer.update();
+
     if (closeWindowAction.isActive()) {
       window.close();
     }
@@ -143,28 +228,23 @@ int main(int argc, char *argv[]) {
       auto sz = window.getSize();
 
       // fake resize event (not sent when going fullscreen before SFML 2.3.1)
-      sf::Event event;
-      event.type = sf::Event::Resized;
-      event.size.width = sz.x;
-      event.size.height = sz.y;
-      cameras.update(event);
-      geometry.update(event);
+      events.postEvent(WindowResizedEvent(sz.x, sz.y));
     }
 
+    events.dispatchQueued();
+
     // update
-    auto elapsed = clock.restart();
-    auto dt = elapsed.asSeconds();
-    mainEntities.update(dt);
-    hudEntities.update(dt);
+    resources.update();
+    float alpha = loop.update();
 
     // render
     window.clear(sf::Color::White);
 
     mainCamera.configure(window);
-    mainEntities.render(window);
+    mainEntities.render(batch, mainCamera.getVisibleRect(), alpha);
 
     hudCamera.configure(window);
-    hudEntities.render(window);
+    hudEntities.render(batch, alpha);
 
     window.display();
 